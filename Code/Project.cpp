@@ -14,6 +14,47 @@
 #include <sstream>
 #include <ctime>
 #include <cstdlib>
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <array>
+#include <mutex>
+#include <thread>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <new>
+#include <utility>
+#include <bitset>
+#include <deque>
+#include <condition_variable>
+#include <stdexcept>
+#include <cerrno>
+#include <filesystem>
+
+// Coroutine-based notification I/O needs C++20 coroutines and epoll
+#if defined(__cpp_impl_coroutine) && defined(__linux__)
+#define ASYNC_NOTIFICATIONS 1
+#include <coroutine>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+// CPU pinning, SCHED_FIFO and mlockall for the CRITICAL dispatch lane;
+// priority-inheritance mutexes for patient state
+#if defined(__linux__)
+#define LANE_PLACEMENT 1
+#define PRIORITY_INHERITANCE 1
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
 
 // Forward declarations
 class Patient;
@@ -37,29 +78,168 @@ enum class VitalSign {
     RESPIRATORY_RATE
 };
 
+constexpr size_t VITAL_SIGN_COUNT = 5;
+
+// What raised an alert: one vital's reading, a trend in one vital, or the
+// patient-level NEWS2 score (whose relatedVital is only the vital whose
+// reading moved the score)
+enum class AlertKind : std::uint8_t {
+    READING = 0,
+    TREND = 1,
+    SCORE = 2
+};
+
+// Monitoring clock
+// Monotonic timestamp source for all latency math. Real mode reads
+// steady_clock (vDSO-backed, immune to NTP steps); simulated mode returns a
+// virtual time that tests and replays advance explicitly. Wall time is only
+// derived for display/archives through a calibrated anchor pair.
+class MonitorClock {
+public:
+    using rep = std::int64_t;
+    using period = std::nano;
+    using duration = std::chrono::duration<rep, period>;
+    using time_point = std::chrono::time_point<MonitorClock, duration>;
+    static constexpr bool is_steady = true;
+    
+    static time_point now() {
+        if (simulated.load(std::memory_order_relaxed)) {
+            return time_point(duration(virtualNanos.load(std::memory_order_relaxed)));
+        }
+        return time_point(std::chrono::duration_cast<duration>(
+            std::chrono::steady_clock::now().time_since_epoch()));
+    }
+    
+    // Switch to virtual time starting at 'start'; wall mapping is re-anchored
+    // so simulated timestamps display as starting from the current wall time
+    static void useSimulatedTime(time_point start) {
+        virtualNanos.store(start.time_since_epoch().count(), std::memory_order_relaxed);
+        originNanos.store(start.time_since_epoch().count(), std::memory_order_relaxed);
+        simulated.store(true, std::memory_order_relaxed);
+        calibrate();
+    }
+    
+    static void useRealTime() {
+        simulated.store(false, std::memory_order_relaxed);
+        originNanos.store(0, std::memory_order_relaxed);
+        calibrate();
+    }
+    
+    // Start of the current simulated run (the epoch in real mode). Simulated
+    // signals are functions of time since the origin, so a seed reproduces
+    // them whatever wall time the run starts at.
+    static time_point origin() {
+        return time_point(duration(originNanos.load(std::memory_order_relaxed)));
+    }
+    
+    static bool isSimulated() {
+        return simulated.load(std::memory_order_relaxed);
+    }
+    
+    static void advance(duration d) {
+        virtualNanos.fetch_add(d.count(), std::memory_order_relaxed);
+    }
+    
+    static void advanceTo(time_point t) {
+        // Virtual time never moves backwards
+        rep target = t.time_since_epoch().count();
+        rep current = virtualNanos.load(std::memory_order_relaxed);
+        while (current < target &&
+               !virtualNanos.compare_exchange_weak(current, target, std::memory_order_relaxed)) {
+        }
+    }
+    
+    // Capture a (monotonic, wall) pair used by toWallClock
+    static void calibrate() {
+        anchorMonoNanos.store(now().time_since_epoch().count(), std::memory_order_relaxed);
+        anchorWallNanos.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+    }
+    
+    static std::chrono::system_clock::time_point toWallClock(time_point t) {
+        static const bool calibrated = (calibrate(), true);
+        (void)calibrated;
+        
+        std::chrono::nanoseconds wall(anchorWallNanos.load(std::memory_order_relaxed) +
+            (t.time_since_epoch().count() - anchorMonoNanos.load(std::memory_order_relaxed)));
+        return std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(wall));
+    }
+    
+private:
+    inline static std::atomic<bool> simulated{false};
+    inline static std::atomic<rep> virtualNanos{0};
+    inline static std::atomic<rep> originNanos{0};
+    inline static std::atomic<rep> anchorMonoNanos{0};
+    inline static std::atomic<std::int64_t> anchorWallNanos{0};
+};
+
 // Data structures
 struct VitalReading {
     VitalSign type;
     double value;
-    std::chrono::system_clock::time_point timestamp;
+    MonitorClock::time_point timestamp;
     int patientId;
     
     VitalReading(VitalSign t, double v, int pid) 
-        : type(t), value(v), patientId(pid), 
-          timestamp(std::chrono::system_clock::now()) {}
+        : type(t), value(v), timestamp(MonitorClock::now()), patientId(pid) {}
+    
+    VitalReading(VitalSign t, double v, int pid, MonitorClock::time_point ts)
+        : type(t), value(v), timestamp(ts), patientId(pid) {}
+    
+    // Empty slot in preallocated history storage
+    VitalReading() : type(VitalSign::HEART_RATE), value(0.0), patientId(0) {}
 };
 
 struct Alert {
+    std::uint64_t alertId;
     int patientId;
     Priority priority;
     std::string message;
     VitalSign relatedVital;
-    std::chrono::system_clock::time_point createdAt;
-    bool acknowledged;
+    AlertKind kind;
+    MonitorClock::time_point createdAt;
+    std::atomic<bool> acknowledged;
+    std::atomic<bool> closed;   // patient released while the alert was open
+    std::atomic<bool> expired;  // escalations exhausted; stays open until acknowledged
+    int escalationLevel; // 0 = original, n = re-raised n times while unacknowledged
+    
+    // Coalesced repeats of the same condition (see AlertCoalescer)
+    int occurrenceCount;
+    MonitorClock::time_point lastSeen;
+    double worstValue;
+    
+    // Low bits of an alert id carry the patient's shard, so id and patient
+    // lookups in the outstanding-alerts table land on the same shard
+    static constexpr int ID_SHARD_BITS = 6;
+    
+    Alert(int pid, Priority p, const std::string& msg, VitalSign vital, AlertKind alertKind = AlertKind::READING)
+        : alertId(nextAlertId(pid)), patientId(pid), priority(p), message(msg), relatedVital(vital), kind(alertKind),
+          createdAt(MonitorClock::now()), acknowledged(false), closed(false), expired(false), escalationLevel(0),
+          occurrenceCount(1), lastSeen(createdAt), worstValue(0.0) {}
+    
+    // Snapshot with the same id, e.g. for handlers on other threads while
+    // coalescing keeps updating the original
+    Alert(const Alert& other)
+        : alertId(other.alertId), patientId(other.patientId), priority(other.priority), message(other.message),
+          relatedVital(other.relatedVital), kind(other.kind), createdAt(other.createdAt), acknowledged(other.acknowledged.load()),
+          closed(other.closed.load()), expired(other.expired.load()), escalationLevel(other.escalationLevel), occurrenceCount(other.occurrenceCount),
+          lastSeen(other.lastSeen), worstValue(other.worstValue) {}
+    Alert& operator=(const Alert&) = delete;
+    
+    static size_t shardOfPatient(int pid) {
+        return static_cast<size_t>(static_cast<unsigned>(pid)) & ((1u << ID_SHARD_BITS) - 1);
+    }
+    
+    static size_t shardOfAlert(std::uint64_t id) {
+        return static_cast<size_t>(id & ((1u << ID_SHARD_BITS) - 1));
+    }
     
-    Alert(int pid, Priority p, const std::string& msg, VitalSign vital)
-        : patientId(pid), priority(p), message(msg), relatedVital(vital),
-          createdAt(std::chrono::system_clock::now()), acknowledged(false) {}
+private:
+    static std::uint64_t nextAlertId(int pid) {
+        static std::atomic<std::uint64_t> counter{1};
+        return (counter.fetch_add(1, std::memory_order_relaxed) << ID_SHARD_BITS) | shardOfPatient(pid);
+    }
 };
 
 // Comparator for priority queue
@@ -72,512 +252,7297 @@ struct AlertComparator {
     }
 };
 
-// Patient class (without threading)
-class Patient {
-private:
-    int patientId;
-    std::string name;
-    int age;
-    std::map<VitalSign, std::vector<VitalReading>> vitalHistory;
-    std::map<VitalSign, std::pair<double, double>> normalRanges; // min, max
-    Priority currentRiskLevel;
+// Per-patient vital history slab
+// One fixed-size block holds a ring buffer of the last HISTORY_CAPACITY
+// readings for every vital, so recording a reading never reallocates and a
+// whole patient's history is released by handing one block back.
+// Each vital's ring is published under a seqlock: the single writer
+// (ingestion) never waits or retries, and readers on any thread copy a
+// consistent window lock-free, retrying only when a write overlapped the
+// copy. Slots are relaxed atomic words, which compile to plain moves.
+struct HistorySlab {
+    static constexpr size_t HISTORY_CAPACITY = 100;
     
-public:
-    Patient(int id, const std::string& patientName, int patientAge) 
-        : patientId(id), name(patientName), age(patientAge), currentRiskLevel(Priority::LOW) {
-        initializeNormalRanges();
+    void clear() {
+        for (size_t v = 0; v < VITAL_SIGN_COUNT; ++v) {
+            head[v].store(0, std::memory_order_relaxed);
+            count[v].store(0, std::memory_order_relaxed);
+        }
     }
     
-    void initializeNormalRanges() {
-        normalRanges[VitalSign::HEART_RATE] = {60.0, 100.0};
-        normalRanges[VitalSign::BLOOD_PRESSURE] = {90.0, 140.0}; // systolic
-        normalRanges[VitalSign::OXYGEN_SATURATION] = {95.0, 100.0};
-        normalRanges[VitalSign::TEMPERATURE] = {36.1, 37.2}; // Celsius
-        normalRanges[VitalSign::RESPIRATORY_RATE] = {12.0, 20.0};
+    // Writer only
+    void push(const VitalReading& reading) {
+        size_t v = static_cast<size_t>(reading.type);
+        std::uint32_t sequence = version[v].load(std::memory_order_relaxed);
+        version[v].store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        
+        std::uint32_t position = head[v].load(std::memory_order_relaxed);
+        Slot& slot = readings[v][position];
+        slot.words[0].store(static_cast<std::uint32_t>(reading.type) |
+                            static_cast<std::uint64_t>(static_cast<std::uint32_t>(reading.patientId)) << 32,
+                            std::memory_order_relaxed);
+        std::uint64_t bits;
+        std::memcpy(&bits, &reading.value, sizeof(bits));
+        slot.words[1].store(bits, std::memory_order_relaxed);
+        slot.words[2].store(static_cast<std::uint64_t>(reading.timestamp.time_since_epoch().count()),
+                            std::memory_order_relaxed);
+        head[v].store((position + 1) % HISTORY_CAPACITY, std::memory_order_relaxed);
+        count[v].store(std::min<std::uint32_t>(count[v].load(std::memory_order_relaxed) + 1, HISTORY_CAPACITY),
+                       std::memory_order_relaxed);
+        
+        version[v].store(sequence + 2, std::memory_order_release);
     }
     
-    void addVitalReading(const VitalReading& reading) {
-        vitalHistory[reading.type].push_back(reading);
-        
-        // Keep only last 100 readings per vital sign
-        if (vitalHistory[reading.type].size() > 100) {
-            vitalHistory[reading.type].erase(vitalHistory[reading.type].begin());
-        }
+    // i-th oldest retained reading of 'vital'; on the writer's thread or
+    // while the patient's lock keeps it from writing
+    VitalReading at(VitalSign vital, size_t i) const {
+        size_t v = static_cast<size_t>(vital);
+        size_t oldest = head[v].load(std::memory_order_relaxed) + HISTORY_CAPACITY - count[v].load(std::memory_order_relaxed);
+        return load(v, (oldest + i) % HISTORY_CAPACITY);
     }
     
-    Priority assessRisk(const VitalReading& reading) {
-        auto range = normalRanges[reading.type];
-        double value = reading.value;
-        
-        // Critical conditions
-        if (reading.type == VitalSign::HEART_RATE) {
-            if (value < 30 || value > 180) return Priority::CRITICAL;
-            if (value < 50 || value > 120) return Priority::HIGH;
-        }
-        else if (reading.type == VitalSign::OXYGEN_SATURATION) {
-            if (value < 85) return Priority::CRITICAL;
-            if (value < 92) return Priority::HIGH;
-        }
-        else if (reading.type == VitalSign::BLOOD_PRESSURE) {
-            if (value < 60 || value > 200) return Priority::CRITICAL;
-            if (value < 80 || value > 160) return Priority::HIGH;
-        }
-        else if (reading.type == VitalSign::TEMPERATURE) {
-            if (value < 35.0 || value > 39.0) return Priority::HIGH;
-            if (value < 35.5 || value > 38.5) return Priority::MEDIUM;
-        }
-        else if (reading.type == VitalSign::RESPIRATORY_RATE) {
-            if (value < 8 || value > 30) return Priority::HIGH;
-            if (value < 10 || value > 25) return Priority::MEDIUM;
-        }
-        
-        // Normal range check
-        if (value < range.first || value > range.second) {
-            return Priority::MEDIUM;
+    size_t size(VitalSign vital) const { return count[static_cast<size_t>(vital)].load(std::memory_order_relaxed); }
+    
+    // Newest 'limit' readings of 'vital', oldest first, from any thread
+    std::vector<VitalReading> snapshot(VitalSign vital, size_t limit) const {
+        size_t v = static_cast<size_t>(vital);
+        std::vector<VitalReading> copy;
+        while (true) {
+            std::uint32_t before = version[v].load(std::memory_order_acquire);
+            if (before & 1) {
+                std::this_thread::yield();   // a write is in progress
+                continue;
+            }
+            size_t position = head[v].load(std::memory_order_relaxed);
+            size_t available = count[v].load(std::memory_order_relaxed);
+            size_t taken = std::min(limit, available);
+            copy.resize(taken);
+            for (size_t i = 0; i < taken; ++i) {
+                copy[i] = load(v, (position + HISTORY_CAPACITY - taken + i) % HISTORY_CAPACITY);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (version[v].load(std::memory_order_relaxed) == before) return copy;
         }
-        
-        return Priority::LOW;
     }
     
-    bool detectTrend(VitalSign vital) {
-        auto& history = vitalHistory[vital];
-        
-        if (history.size() < 5) return false;
-        
-        // Simple trend detection: check if last 5 readings show consistent change
-        double sum = 0;
-        for (size_t i = history.size() - 4; i < history.size(); i++) {
-            sum += history[i].value - history[i-1].value;
+private:
+    // type | patientId << 32, value bits, timestamp ticks
+    struct Slot {
+        std::atomic<std::uint64_t> words[3];
+    };
+    
+    Slot readings[VITAL_SIGN_COUNT][HISTORY_CAPACITY];
+    std::atomic<std::uint32_t> head[VITAL_SIGN_COUNT];    // next write position
+    std::atomic<std::uint32_t> count[VITAL_SIGN_COUNT];
+    std::atomic<std::uint32_t> version[VITAL_SIGN_COUNT];   // odd while a write is in progress
+    
+    VitalReading load(size_t v, size_t position) const {
+        const Slot& slot = readings[v][position];
+        std::uint64_t tag = slot.words[0].load(std::memory_order_relaxed);
+        std::uint64_t bits = slot.words[1].load(std::memory_order_relaxed);
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        auto ticks = static_cast<MonitorClock::rep>(slot.words[2].load(std::memory_order_relaxed));
+        return VitalReading(static_cast<VitalSign>(tag & 0xFFFFFFFFu), value,
+                            static_cast<int>(static_cast<std::uint32_t>(tag >> 32)),
+                            MonitorClock::time_point(MonitorClock::duration(ticks)));
+    }
+};
+
+// Process-wide pool of history slabs
+// Slabs are carved from large chunks and recycled through a free list, so
+// admission and discharge are O(1) and memory stays flat as beds turn over.
+class HistorySlabPool {
+public:
+    static constexpr size_t SLABS_PER_CHUNK = 32;
+    
+    static HistorySlabPool& instance() {
+        static HistorySlabPool pool;
+        return pool;
+    }
+    
+    HistorySlab* acquire() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (freeList.empty()) {
+            chunks.push_back(std::make_unique<HistorySlab[]>(SLABS_PER_CHUNK));
+            for (size_t i = SLABS_PER_CHUNK; i-- > 0;) {
+                freeList.push_back(&chunks.back()[i]);
+            }
         }
-        
-        double avgChange = sum / 4.0;
-        return std::abs(avgChange) > 2.0; // Threshold for concerning trend
+        HistorySlab* slab = freeList.back();
+        freeList.pop_back();
+        slab->clear();
+        return slab;
     }
     
-    std::vector<VitalReading> getRecentReadings(VitalSign vital, int count = 10) {
-        auto& history = vitalHistory[vital];
-        
-        if (history.empty()) return {};
-        
-        int start = std::max(0, static_cast<int>(history.size()) - count);
-        return std::vector<VitalReading>(history.begin() + start, history.end());
+    void release(HistorySlab* slab) {
+        std::lock_guard<std::mutex> lock(mutex);
+        freeList.push_back(slab);
+    }
+    
+    size_t getCapacity() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return chunks.size() * SLABS_PER_CHUNK;
+    }
+    
+    size_t getInUse() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return chunks.size() * SLABS_PER_CHUNK - freeList.size();
     }
     
-    int getId() const { return patientId; }
-    std::string getName() const { return name; }
-    Priority getCurrentRisk() const { return currentRiskLevel; }
-    void setCurrentRisk(Priority risk) { currentRiskLevel = risk; }
-};
-
-// Medical Device class (simplified without threads)
-class MedicalDevice {
 private:
-    int deviceId;
-    VitalSign monitoredVital;
-    int assignedPatient;
-    bool isActive;
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<HistorySlab[]>> chunks;
+    std::vector<HistorySlab*> freeList;
     
+    HistorySlabPool() = default;
+};
+
+struct HistorySlabRelease {
+    void operator()(HistorySlab* slab) const {
+        HistorySlabPool::instance().release(slab);
+    }
+};
+
+// NEWS2 aggregate early-warning score
+// Keeps the latest sub-score of each vital, so a reading updates the total
+// in O(1) instead of rescanning the chart. Uses the NEWS2 tables for
+// respiration rate, SpO2 (scale 1), systolic BP, pulse and temperature;
+// consciousness and supplemental oxygen are not monitored and score 0.
+class EarlyWarningScore {
 public:
-    MedicalDevice(int id, VitalSign vital, int patientId) 
-        : deviceId(id), monitoredVital(vital), assignedPatient(patientId), isActive(true) {}
+    enum class Band : std::uint8_t { LOW = 0, LOW_MEDIUM = 1, MEDIUM = 2, HIGH = 3 };
+    static constexpr int MAX_SCORE = 3 * static_cast<int>(VITAL_SIGN_COUNT);
     
-    VitalReading generateReading() {
-        double baseValue = getBaseValue();
-        
-        // Add realistic variation and occasional abnormal readings
-        double noise = ((rand() % 21) - 10) * 0.1; // Random noise ±1.0
-        
-        // 10% chance of generating abnormal reading for testing
-        if ((rand() % 100) < 10) {
-            noise += getAbnormalSpike();
-        }
-        
-        return VitalReading(monitoredVital, baseValue + noise, assignedPatient);
+    EarlyWarningScore() : subScores{}, total(0), redScores(0) {}
+    
+    // Folds in the latest value of one vital; returns the new band
+    Band update(VitalSign vital, double value) {
+        size_t v = static_cast<size_t>(vital);
+        int score = subScore(vital, value);
+        total += score - subScores[v];
+        redScores += (score == 3) - (subScores[v] == 3);
+        subScores[v] = static_cast<std::uint8_t>(score);
+        return getBand();
     }
     
-    void stopMonitoring() {
-        isActive = false;
+    int getScore() const { return total; }
+    
+    // 7+ high, 5-6 medium, a single parameter scoring 3 is low-medium
+    Band getBand() const {
+        if (total >= 7) return Band::HIGH;
+        if (total >= 5) return Band::MEDIUM;
+        return redScores > 0 ? Band::LOW_MEDIUM : Band::LOW;
     }
     
-    bool isDeviceActive() const {
-        return isActive;
+    // Alert priority for a band: emergency response at HIGH is CRITICAL
+    static Priority alertPriority(Band band) {
+        static const Priority table[] = {Priority::LOW, Priority::MEDIUM, Priority::HIGH, Priority::CRITICAL};
+        return table[static_cast<size_t>(band)];
     }
     
-    int getPatientId() const {
-        return assignedPatient;
+    static const char* bandName(Band band) {
+        static const char* names[] = {"low", "low-medium", "medium", "high"};
+        return names[static_cast<size_t>(band)];
     }
     
-    VitalSign getVitalSign() const {
-        return monitoredVital;
+    // Sub-score = score[number of upper bounds the value exceeds]
+    static int subScore(VitalSign vital, double value) {
+        static const double INF = std::numeric_limits<double>::infinity();
+        static const Scale scales[VITAL_SIGN_COUNT] = {
+            {{40.0, 50.0, 90.0, 110.0, 130.0}, {3, 1, 0, 1, 2, 3}},   // HEART_RATE
+            {{90.0, 100.0, 110.0, 219.0, INF}, {3, 2, 1, 0, 3, 3}},   // BLOOD_PRESSURE (systolic)
+            {{91.0, 93.0, 95.0, INF, INF}, {3, 2, 1, 0, 0, 0}},       // OXYGEN_SATURATION (scale 1)
+            {{35.0, 36.0, 38.0, 39.0, INF}, {3, 1, 0, 1, 2, 2}},      // TEMPERATURE
+            {{8.0, 11.0, 20.0, 24.0, INF}, {3, 1, 0, 2, 3, 3}}        // RESPIRATORY_RATE
+        };
+        const Scale& scale = scales[static_cast<size_t>(vital)];
+        int above = 0;
+        for (double upper : scale.upper) {
+            above += value > upper;
+        }
+        return scale.score[above];
     }
     
 private:
-    double getBaseValue() {
-        switch (monitoredVital) {
-            case VitalSign::HEART_RATE: return 75.0;
-            case VitalSign::BLOOD_PRESSURE: return 120.0;
-            case VitalSign::OXYGEN_SATURATION: return 98.0;
-            case VitalSign::TEMPERATURE: return 36.8;
-            case VitalSign::RESPIRATORY_RATE: return 16.0;
-            default: return 0.0;
+    struct Scale {
+        double upper[5];
+        std::uint8_t score[6];
+    };
+    
+    std::uint8_t subScores[VITAL_SIGN_COUNT];
+    int total;
+    int redScores;   // parameters currently scoring 3
+};
+
+// Streaming per-vital baseline of one patient
+// Exponentially weighted median and median absolute deviation, learned by
+// sign-driven stochastic approximation: each reading nudges both estimates
+// by a step proportional to the current spread. Two doubles of state, O(1)
+// per reading, and older readings fade so the band follows slow drift.
+class AdaptiveBaseline {
+public:
+    static constexpr int WARMUP_READINGS = 30;
+    static constexpr double LEARNING_RATE = 0.02;
+    static constexpr double BAND_WIDTH = 3.0;   // robust sigmas either side
+    
+    AdaptiveBaseline() : median(0.0), mad(0.0), count(0) {}
+    
+    void update(VitalSign vital, double value) {
+        double floor = minSpread(vital);
+        if (count == 0) {
+            median = value;
+            mad = floor;
+        } else {
+            double step = LEARNING_RATE * std::max(mad, floor);
+            median += (value > median) ? step : ((value < median) ? -step : 0.0);
+            mad = std::max(0.5 * floor, mad + ((std::abs(value - median) > mad) ? step : -step));
         }
+        if (count < WARMUP_READINGS) count++;
     }
     
-    double getAbnormalSpike() {
-        return ((rand() % 61) - 30); // Random spike ±30
+    bool isWarm() const { return count >= WARMUP_READINGS; }
+    double getMedian() const { return median; }
+    double getSpread() const { return 1.4826 * mad; }   // MAD scaled to a normal sigma
+    double lower() const { return median - BAND_WIDTH * getSpread(); }
+    double upper() const { return median + BAND_WIDTH * getSpread(); }
+    bool contains(double value) const { return value >= lower() && value <= upper(); }
+    
+    // Smallest spread worth resolving, about the sensor's noise floor
+    static double minSpread(VitalSign vital) {
+        static const double table[VITAL_SIGN_COUNT] = {2.0, 4.0, 0.5, 0.1, 1.0};
+        return table[static_cast<size_t>(vital)];
     }
+    
+private:
+    double median;
+    double mad;
+    int count;
 };
 
-// False Alarm Detector
-class FalseAlarmDetector {
+// KLL streaming quantile sketch
+// Level h holds items of weight 2^h; when the sketch outgrows its budget
+// the lowest over-full level is sorted and every other item is promoted, so
+// memory is O(k) however many values are fed in and rank error is roughly
+// 1.7/k. Sketches with the same k merge by concatenating levels, and
+// serialize to a compact binary snapshot.
+class KllSketch {
 public:
-    static bool isLikelyFalseAlarm(const Alert& alert, const std::vector<VitalReading>& recentReadings) {
-        if (recentReadings.size() < 5) return false; // Need sufficient data
-        
-        double mean = calculateMean(recentReadings);
-        double stdDev = calculateStandardDeviation(recentReadings, mean);
-        
-        if (stdDev == 0) return false; // Avoid division by zero
-        
-        // If current reading is within 1.5 standard deviations, might be false alarm
-        double currentValue = recentReadings.back().value;
-        double zScore = std::abs((currentValue - mean) / stdDev);
-        
-        // Different thresholds for different priority levels
-        double threshold = (alert.priority == Priority::CRITICAL) ? 2.5 : 1.5;
-        
-        return zScore < threshold;
+    static constexpr int DEFAULT_K = 200;
+    
+    explicit KllSketch(int k = DEFAULT_K) : k(std::max(8, k)), count(0), coin(false), levels(1) {
+        refreshCapacity();
     }
     
-private:
-    static double calculateMean(const std::vector<VitalReading>& readings) {
-        double sum = 0.0;
-        for (const auto& reading : readings) {
-            sum += reading.value;
-        }
-        return sum / readings.size();
+    void update(double value) {
+        levels[0].push_back(static_cast<float>(value));
+        count++;
+        if (++retained >= capacity) compress();
     }
     
-    static double calculateStandardDeviation(const std::vector<VitalReading>& readings, double mean) {
-        double variance = 0.0;
-        for (const auto& reading : readings) {
-            variance += std::pow(reading.value - mean, 2);
+    void merge(const KllSketch& other) {
+        if (levels.size() < other.levels.size()) {
+            levels.resize(other.levels.size());
+            refreshCapacity();
+        }
+        for (size_t h = 0; h < other.levels.size(); ++h) {
+            levels[h].insert(levels[h].end(), other.levels[h].begin(), other.levels[h].end());
         }
-        return std::sqrt(variance / readings.size());
+        count += other.count;
+        retained += other.retained;
+        while (retained >= capacity) compress();
     }
-};
-
-// Alert Processor (simplified without threading)
-class AlertProcessor {
-private:
-    std::priority_queue<std::shared_ptr<Alert>, std::vector<std::shared_ptr<Alert>>, AlertComparator> alertQueue;
-    long totalAlertsProcessed;
-    long falseAlarmsFiltered;
     
-public:
-    AlertProcessor() : totalAlertsProcessed(0), falseAlarmsFiltered(0) {}
+    void clear() {
+        levels.assign(1, std::vector<float>());
+        count = 0;
+        retained = 0;
+        refreshCapacity();
+    }
     
-    void addAlert(std::shared_ptr<Alert> alert) {
-        alertQueue.push(alert);
+    std::uint64_t getCount() const { return count; }
+    bool empty() const { return count == 0; }
+    int getK() const { return k; }
+    
+    // Approximate q-quantile (q in [0, 1]); NaN when empty
+    double quantile(double q) const {
+        auto items = weightedItems();
+        if (items.empty()) return std::numeric_limits<double>::quiet_NaN();
+        double target = std::min(1.0, std::max(0.0, q)) * static_cast<double>(totalWeight(items));
+        std::uint64_t cumulative = 0;
+        for (const auto& item : items) {
+            cumulative += item.second;
+            if (static_cast<double>(cumulative) >= target) return item.first;
+        }
+        return items.back().first;
     }
     
-    void processNextAlert() {
-        if (!alertQueue.empty()) {
-            auto alert = alertQueue.top();
-            alertQueue.pop();
-            handleAlert(alert);
-            totalAlertsProcessed++;
+    // Approximate fraction of values <= 'value'
+    double rank(double value) const {
+        std::uint64_t below = 0, total = 0;
+        for (size_t h = 0; h < levels.size(); ++h) {
+            for (float item : levels[h]) {
+                total += 1ULL << h;
+                if (item <= value) below += 1ULL << h;
+            }
         }
+        return total ? static_cast<double>(below) / total : std::numeric_limits<double>::quiet_NaN();
     }
     
-    void processAllAlerts() {
-        while (!alertQueue.empty()) {
-            processNextAlert();
+    // Snapshot: magic, k, count, level count, then per level size and items
+    void serialize(std::ostream& out) const {
+        std::uint32_t header[2] = {static_cast<std::uint32_t>(k), static_cast<std::uint32_t>(levels.size())};
+        out.write(MAGIC, sizeof(MAGIC));
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        for (const auto& level : levels) {
+            std::uint32_t size = static_cast<std::uint32_t>(level.size());
+            out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            out.write(reinterpret_cast<const char*>(level.data()), size * sizeof(float));
         }
     }
     
-    long getTotalAlertsProcessed() const { return totalAlertsProcessed; }
-    long getFalseAlarmsFiltered() const { return falseAlarmsFiltered; }
-    bool hasAlerts() const { return !alertQueue.empty(); }
+    static bool deserialize(std::istream& in, KllSketch& sketch) {
+        char magic[sizeof(MAGIC)];
+        std::uint32_t header[2];
+        std::uint64_t total;
+        if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+            !in.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+            !in.read(reinterpret_cast<char*>(&total), sizeof(total)) ||
+            header[1] == 0 || header[1] > 64) {
+            return false;
+        }
+        KllSketch result(static_cast<int>(header[0]));
+        result.levels.resize(header[1]);
+        result.count = total;
+        result.retained = 0;
+        for (auto& level : result.levels) {
+            std::uint32_t size;
+            if (!in.read(reinterpret_cast<char*>(&size), sizeof(size)) || size > (1u << 24)) return false;
+            level.resize(size);
+            if (!in.read(reinterpret_cast<char*>(level.data()), size * sizeof(float))) return false;
+            result.retained += size;
+        }
+        result.refreshCapacity();
+        sketch = std::move(result);
+        return true;
+    }
     
 private:
-    void handleAlert(std::shared_ptr<Alert> alert) {
-        auto now = std::chrono::system_clock::now();
-        auto responseTime = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now - alert->createdAt).count();
-            
-        // Check response time requirements
-        bool withinTimeRequirement = checkResponseTimeRequirement(alert->priority, responseTime);
-        
-        // Log the alert with response time
-        std::cout << "[" << getCurrentTimeString() << "] "
-                  << "[" << priorityToString(alert->priority) << "] "
-                  << "Patient " << alert->patientId << ": " << alert->message 
-                  << " (Response: " << responseTime << "ms)" 
-                  << (withinTimeRequirement ? " ✓" : " ⚠") << std::endl;
-        
-        // Simulate alert handling based on priority
-        switch (alert->priority) {
-            case Priority::CRITICAL:
-                handleCriticalAlert(alert);
-                break;
-            case Priority::HIGH:
-                handleHighAlert(alert);
-                break;
-            case Priority::MEDIUM:
-                handleMediumAlert(alert);
-                break;
-            case Priority::LOW:
-                handleLowAlert(alert);
-                break;
+    static constexpr char MAGIC[4] = {'K', 'L', 'L', '1'};
+    static constexpr size_t MIN_LEVEL_CAPACITY = 8;
+    
+    int k;
+    std::uint64_t count;
+    size_t retained = 0;
+    size_t capacity = 0;
+    bool coin;   // alternating offset keeps compaction deterministic
+    std::vector<std::vector<float>> levels;
+    std::vector<size_t> levelCapacities;
+    
+    // Capacity of level h shrinks by 2/3 per level below the top. Level 0
+    // is an unsorted input buffer of k items, so compaction (a sort) runs
+    // about once per k/2 inserts instead of every few.
+    void refreshCapacity() {
+        levelCapacities.resize(levels.size());
+        capacity = 0;
+        for (size_t h = 0; h < levels.size(); ++h) {
+            double depth = static_cast<double>(levels.size() - 1 - h);
+            levelCapacities[h] = (h == 0) ? static_cast<size_t>(k)
+                : std::max(MIN_LEVEL_CAPACITY, static_cast<size_t>(k * std::pow(2.0 / 3.0, depth)));
+            capacity += levelCapacities[h];
         }
     }
     
-    bool checkResponseTimeRequirement(Priority priority, long responseTimeMs) {
-        switch (priority) {
-            case Priority::CRITICAL: return responseTimeMs <= 2000;
-            case Priority::HIGH: return responseTimeMs <= 30000;
-            case Priority::MEDIUM: return responseTimeMs <= 300000;
-            case Priority::LOW: return responseTimeMs <= 3600000;
-            default: return true;
+    void compress() {
+        for (size_t h = 0; h < levels.size(); ++h) {
+            if (levels[h].size() < levelCapacities[h]) continue;
+            if (h + 1 == levels.size()) {
+                levels.emplace_back();
+                refreshCapacity();
+            }
+            std::vector<float>& level = levels[h];
+            std::sort(level.begin(), level.end());
+            
+            // An odd item out stays behind; the rest halve into level h+1
+            size_t paired = level.size() & ~static_cast<size_t>(1);
+            size_t offset = coin ? 1 : 0;
+            coin = !coin;
+            for (size_t i = offset; i < paired; i += 2) {
+                levels[h + 1].push_back(level[i]);
+            }
+            level.erase(level.begin(), level.begin() + static_cast<std::ptrdiff_t>(paired));
+            retained -= paired / 2;
+            return;
         }
     }
     
-    void handleCriticalAlert(std::shared_ptr<Alert> alert) {
-        std::cout << "    >>> CRITICAL ALERT: Immediate medical attention required!" << std::endl;
+    std::vector<std::pair<float, std::uint64_t>> weightedItems() const {
+        std::vector<std::pair<float, std::uint64_t>> items;
+        for (size_t h = 0; h < levels.size(); ++h) {
+            for (float item : levels[h]) {
+                items.emplace_back(item, 1ULL << h);
+            }
+        }
+        std::sort(items.begin(), items.end());
+        return items;
     }
     
-    void handleHighAlert(std::shared_ptr<Alert> alert) {
-        std::cout << "    >>> HIGH PRIORITY: Nurse response needed within 30 seconds" << std::endl;
+    static std::uint64_t totalWeight(const std::vector<std::pair<float, std::uint64_t>>& items) {
+        std::uint64_t total = 0;
+        for (const auto& item : items) total += item.second;
+        return total;
     }
+};
+
+// Sliding-window pair of sketches
+// Values go into the current epoch; when it is older than the epoch length
+// it becomes the previous one and the oldest is dropped. Queries merge the
+// two, so they cover between one and two epochs of recent history.
+class WindowedSketch {
+public:
+    WindowedSketch(MonitorClock::duration epoch, int k = KllSketch::DEFAULT_K)
+        : epochLength(epoch), current(k), previous(k), started(false) {}
     
-    void handleMediumAlert(std::shared_ptr<Alert> alert) {
-        std::cout << "    >>> MEDIUM: Check on patient within 5 minutes" << std::endl;
+    void update(double value, MonitorClock::time_point now) {
+        rotate(now);
+        current.update(value);
     }
     
-    void handleLowAlert(std::shared_ptr<Alert> alert) {
-        std::cout << "    >>> LOW: Routine check during next rounds" << std::endl;
+    // Snapshot of the window as of 'now'
+    KllSketch snapshot(MonitorClock::time_point now) {
+        rotate(now);
+        KllSketch merged = previous;
+        merged.merge(current);
+        return merged;
     }
     
-    std::string priorityToString(Priority p) {
-        switch (p) {
-            case Priority::CRITICAL: return "CRITICAL";
-            case Priority::HIGH: return "HIGH    ";
-            case Priority::MEDIUM: return "MEDIUM  ";
-            case Priority::LOW: return "LOW     ";
-            default: return "UNKNOWN ";
+private:
+    MonitorClock::duration epochLength;
+    KllSketch current;
+    KllSketch previous;
+    MonitorClock::time_point epochStart;
+    bool started;
+    
+    void rotate(MonitorClock::time_point now) {
+        if (!started) {
+            started = true;
+            epochStart = now;
+            return;
+        }
+        if (now - epochStart < epochLength) return;
+        if (now - epochStart >= 2 * epochLength) {
+            previous.clear();   // idle for more than a whole window
+        } else {
+            std::swap(previous, current);
         }
+        current.clear();
+        epochStart = now;
     }
+};
+
+// K-of-N confirmation rules for non-LOW readings
+// A reading of priority P is promoted to an alert only once at least k of
+// the last n samples of that vital were at P or worse. Rules apply to the
+// vitals in 'vitals' (a bit per VitalSign); spot measurements such as cuff
+// BP and temperature are minutes apart, so by default they alert at once.
+struct ConfirmationPolicy {
+    struct Rule {
+        std::uint8_t k;
+        std::uint8_t n;   // at most AlarmConfirmation::WINDOW
+    };
     
-    std::string getCurrentTimeString() {
-        auto now = std::chrono::system_clock::now();
-        auto time_t = std::chrono::system_clock::to_time_t(now);
-        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now.time_since_epoch()) % 1000;
+    Rule rules[3];           // CRITICAL, HIGH, MEDIUM
+    bool criticalBypass;     // CRITICAL readings alert on the first sample
+    std::uint8_t vitals;
+    
+    static ConfirmationPolicy standard() {
+        ConfirmationPolicy policy{{{2, 3}, {2, 3}, {3, 5}}, true, 0};
+        policy.vitals = bit(VitalSign::HEART_RATE) | bit(VitalSign::OXYGEN_SATURATION) |
+                        bit(VitalSign::RESPIRATORY_RATE);
+        return policy;
+    }
+    
+    // Every abnormal sample alerts, as before confirmation existed
+    static ConfirmationPolicy immediate() {
+        return ConfirmationPolicy{{{1, 1}, {1, 1}, {1, 1}}, true, 0};
+    }
+    
+    const Rule& rule(Priority priority) const { return rules[static_cast<int>(priority) - 1]; }
+    Rule& rule(Priority priority) { return rules[static_cast<int>(priority) - 1]; }
+    bool applies(VitalSign vital) const { return (vitals & bit(vital)) != 0; }
+    
+    static std::uint8_t bit(VitalSign vital) { return static_cast<std::uint8_t>(1u << static_cast<int>(vital)); }
+};
+
+// Pending-alert state of one patient-vital: one shift register per alarm
+// level holding whether each of the last WINDOW samples was at that level
+// or worse, and one for trend detections. Eight bytes, updated with a shift
+// and a popcount.
+class AlarmConfirmation {
+public:
+    static constexpr int WINDOW = 16;
+    
+    AlarmConfirmation() : history{}, trendHistory(0) {}
+    
+    // Records a sample of 'risk' and returns the most severe priority, no
+    // worse than 'risk', whose rule is now met; LOW while still pending
+    Priority update(Priority risk, const ConfirmationPolicy& policy, bool confirm = true) {
+        for (int level = 0; level < 3; ++level) {
+            history[level] = static_cast<std::uint16_t>((history[level] << 1) | (static_cast<int>(risk) <= level + 1));
+        }
+        if (risk == Priority::LOW || !confirm) return risk;
+        if (risk == Priority::CRITICAL && policy.criticalBypass) return risk;
         
-        std::stringstream ss;
-        ss << std::put_time(std::localtime(&time_t), "%H:%M:%S");
-        ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
-        return ss.str();
+        for (int level = static_cast<int>(risk); level <= static_cast<int>(Priority::MEDIUM); ++level) {
+            if (meets(history[level - 1], policy.rules[level - 1])) {
+                return static_cast<Priority>(level);
+            }
+        }
+        return Priority::LOW;
+    }
+    
+    // Trend alerts are MEDIUM and confirmed under the MEDIUM rule
+    bool updateTrend(bool trending, const ConfirmationPolicy& policy, bool confirm = true) {
+        trendHistory = static_cast<std::uint16_t>((trendHistory << 1) | trending);
+        if (!trending || !confirm) return trending;
+        return meets(trendHistory, policy.rule(Priority::MEDIUM));
+    }
+    
+private:
+    std::uint16_t history[3];   // CRITICAL, HIGH, MEDIUM
+    std::uint16_t trendHistory;
+    
+    static bool meets(std::uint16_t samples, const ConfirmationPolicy::Rule& rule) {
+        std::uint16_t window = static_cast<std::uint16_t>((1u << std::min<int>(rule.n, WINDOW)) - 1);
+        return std::bitset<WINDOW>(samples & window).count() >= rule.k;
     }
 };
 
-// Hospital Scheduler (simplified)
-class HospitalScheduler {
+// Intrusive links of a patient in the scheduler's risk buckets
+struct RiskLink {
+    Patient* prev = nullptr;
+    Patient* next = nullptr;
+    int bucket = -1;   // Priority - 1 while indexed, -1 otherwise
+};
+
+// Mutex that lends a blocked waiter's priority to the holder
+// With PTHREAD_PRIO_INHERIT a SCHED_FIFO thread waiting on a lock held by a
+// normal-class thread boosts the holder until it unlocks, so medium-priority
+// work cannot run in between (priority inversion). Elsewhere, or if the
+// protocol is refused, it is a plain mutex. Meets Lockable.
+class PriorityInheritanceMutex {
+public:
+    PriorityInheritanceMutex() : inheriting(false) {
+#ifdef PRIORITY_INHERITANCE
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        inheriting = pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT) == 0 &&
+                     pthread_mutex_init(&handle, &attr) == 0;
+        if (!inheriting) pthread_mutex_init(&handle, nullptr);
+        pthread_mutexattr_destroy(&attr);
+#endif
+    }
+    
+#ifdef PRIORITY_INHERITANCE
+    ~PriorityInheritanceMutex() { pthread_mutex_destroy(&handle); }
+    void lock() { pthread_mutex_lock(&handle); }
+    bool try_lock() { return pthread_mutex_trylock(&handle) == 0; }
+    void unlock() { pthread_mutex_unlock(&handle); }
+#else
+    void lock() { fallback.lock(); }
+    bool try_lock() { return fallback.try_lock(); }
+    void unlock() { fallback.unlock(); }
+#endif
+    
+    PriorityInheritanceMutex(const PriorityInheritanceMutex&) = delete;
+    PriorityInheritanceMutex& operator=(const PriorityInheritanceMutex&) = delete;
+    
+    bool inheritsPriority() const { return inheriting; }
+    
 private:
-    std::map<int, std::unique_ptr<Patient>> patients;
-    std::vector<std::unique_ptr<MedicalDevice>> devices;
-    std::unique_ptr<AlertProcessor> alertProcessor;
+#ifdef PRIORITY_INHERITANCE
+    pthread_mutex_t handle;
+#else
+    std::mutex fallback;
+#endif
+    bool inheriting;
+};
+
+// Consistent view of one patient for readers on other threads: the recent
+// readings of every vital, the risk and the NEWS2 score all reflect the
+// same completed ingestion step
+struct PatientSnapshot {
+    int patientId;
+    Priority risk;
+    int earlyWarningScore;
+    std::array<std::vector<VitalReading>, VITAL_SIGN_COUNT> recent;   // per VitalSign, oldest first
+};
+
+// Patient class
+// One writer at a time: the scheduler holds lockState() while it ingests a
+// reading. Recent readings, current risk and the NEWS2 score are published
+// for lock-free reads from any thread. Each getter is consistent on its own;
+// snapshot() reads them all under a per-patient publish sequence that each
+// ingestion step bumps (odd while it runs), retrying if a step overlapped,
+// so it never mixes a new reading with the risk or score before it. Other
+// queries take lockState().
+class Patient {
+private:
+    // Absolute alarm bands per vital; MEDIUM also fires outside the
+    // patient's own normal range
+    struct RiskBands {
+        double criticalLow, criticalHigh;
+        double highLow, highHigh;
+        double mediumLow, mediumHigh;
+    };
+    
+    static const RiskBands& riskBands(VitalSign vital) {
+        static const double INF = std::numeric_limits<double>::infinity();
+        static const RiskBands table[VITAL_SIGN_COUNT] = {
+            {30.0, 180.0, 50.0, 120.0, 50.0, 120.0},   // HEART_RATE
+            {60.0, 200.0, 80.0, 160.0, 80.0, 160.0},   // BLOOD_PRESSURE (systolic)
+            {85.0, INF, 92.0, INF, 92.0, INF},         // OXYGEN_SATURATION
+            {-INF, INF, 35.0, 39.0, 35.5, 38.5},       // TEMPERATURE
+            {-INF, INF, 8.0, 30.0, 10.0, 25.0}         // RESPIRATORY_RATE
+        };
+        return table[static_cast<size_t>(vital)];
+    }
+    
+    int patientId;
+    std::string name;
+    int age;
+    std::unique_ptr<HistorySlab, HistorySlabRelease> vitalHistory;   // returned to the pool on destruction
+    std::map<VitalSign, std::pair<double, double>> normalRanges; // min, max
+    // Published for lock-free readers; a move copies the value, as
+    // patients move only while unshared
+    template <typename T>
+    struct Published {
+        std::atomic<T> value;
+        explicit Published(T initial) : value(initial) {}
+        Published(Published&& other) noexcept : value(other.value.load(std::memory_order_relaxed)) {}
+        Published& operator=(Published&& other) noexcept {
+            value.store(other.value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            return *this;
+        }
+    };
+    Published<Priority> currentRiskLevel;
+    Published<int> earlyWarningScore;   // earlyWarning.getScore()
+    Published<std::uint64_t> publishSequence;   // odd while an ingestion step runs
+    Priority vitalRisk[VITAL_SIGN_COUNT];   // risk of the latest reading per vital
+    RiskLink riskLink;
+    EarlyWarningScore earlyWarning;
+    AdaptiveBaseline baselines[VITAL_SIGN_COUNT];
+    std::vector<WindowedSketch> distributions;   // per vital, created with the first reading
+    AlarmConfirmation confirmations[VITAL_SIGN_COUNT];
+    
+    // Patients move only while unshared (admission, transfer), so a moved
+    // patient simply gets a fresh, unlocked mutex
+    struct StateMutex {
+        mutable PriorityInheritanceMutex mutex;
+        StateMutex() = default;
+        StateMutex(StateMutex&&) noexcept {}
+        StateMutex& operator=(StateMutex&&) noexcept { return *this; }
+    };
+    StateMutex stateMutex;
     
 public:
-    HospitalScheduler() {
-        alertProcessor = std::make_unique<AlertProcessor>();
+    // Per-patient sketches cover the last 12-24 h at a small k
+    static constexpr int DISTRIBUTION_K = 32;
+    static constexpr std::chrono::hours DISTRIBUTION_EPOCH{12};
+    
+    Patient(int id, const std::string& patientName, int patientAge) 
+        : patientId(id), name(patientName), age(patientAge),
+          vitalHistory(HistorySlabPool::instance().acquire()), currentRiskLevel(Priority::LOW), earlyWarningScore(0),
+          publishSequence(0) {
+        std::fill(std::begin(vitalRisk), std::end(vitalRisk), Priority::LOW);
+        initializeNormalRanges();
+    }
+    
+    void initializeNormalRanges() {
+        normalRanges[VitalSign::HEART_RATE] = {60.0, 100.0};
+        normalRanges[VitalSign::BLOOD_PRESSURE] = {90.0, 140.0}; // systolic
+        normalRanges[VitalSign::OXYGEN_SATURATION] = {95.0, 100.0};
+        normalRanges[VitalSign::TEMPERATURE] = {36.1, 37.2}; // Celsius
+        normalRanges[VitalSign::RESPIRATORY_RATE] = {12.0, 20.0};
+        
+        // Age-adjusted starting points until the patient's own baseline is learned
+        if (age < 18) {
+            normalRanges[VitalSign::HEART_RATE] = {70.0, 120.0};
+            normalRanges[VitalSign::RESPIRATORY_RATE] = {14.0, 24.0};
+        } else if (age >= 65) {
+            normalRanges[VitalSign::BLOOD_PRESSURE] = {100.0, 150.0};
+            normalRanges[VitalSign::TEMPERATURE] = {35.9, 37.2};
+        }
+    }
+    
+    void addVitalReading(const VitalReading& reading) {
+        // Keeps the last HISTORY_CAPACITY readings per vital sign, plus a
+        // quantile sketch of the longer window
+        vitalHistory->push(reading);
+        if (distributions.empty()) {
+            distributions.assign(VITAL_SIGN_COUNT, WindowedSketch(DISTRIBUTION_EPOCH, DISTRIBUTION_K));
+        }
+        distributions[static_cast<size_t>(reading.type)].update(reading.value, reading.timestamp);
+    }
+    
+    // Copy of this patient's recent window of 'vital', so it can be merged
+    // and ranked without the lock; empty (NaN ranks) before the first reading
+    WindowedSketch recentDistribution(VitalSign vital) const {
+        if (distributions.empty()) return WindowedSketch(DISTRIBUTION_EPOCH, DISTRIBUTION_K);
+        return distributions[static_cast<size_t>(vital)];
+    }
+    
+    Priority assessRisk(const VitalReading& reading) {
+        Priority risk;
+        classifyRisk(reading.type, &reading.value, 1, getNormalRange(reading.type), &risk);
+        return risk;
+    }
+    
+    // Branch-free risk classification of 'count' values of one vital, so a
+    // batch of samples compiles to straight-line (vectorizable) code.
+    // Bands nest: outside critical implies outside high implies MEDIUM.
+    static void classifyRisk(VitalSign vital, const double* values, size_t count,
+                             std::pair<double, double> normalRange, Priority* out) {
+        const RiskBands& bands = riskBands(vital);
+        double mediumLow = std::max(bands.mediumLow, normalRange.first);
+        double mediumHigh = std::min(bands.mediumHigh, normalRange.second);
+        for (size_t i = 0; i < count; ++i) {
+            double value = values[i];
+            int critical = (value < bands.criticalLow) | (value > bands.criticalHigh);
+            int high = (value < bands.highLow) | (value > bands.highHigh) | critical;
+            int medium = (value < mediumLow) | (value > mediumHigh) | high;
+            out[i] = static_cast<Priority>(4 - medium - high - critical);
+        }
+    }
+    
+    // True if 'value' is inside the absolute MEDIUM band, so it can only be
+    // abnormal relative to a patient's own normal range
+    static bool insideMediumBand(VitalSign vital, double value) {
+        const RiskBands& bands = riskBands(vital);
+        return value >= bands.mediumLow && value <= bands.mediumHigh;
+    }
+    
+    // Age-adjusted range, widened to the learned baseline once it is warm.
+    // classifyRisk still caps it at the absolute MEDIUM bands, so learning
+    // can quiet a patient's usual values but never hide HIGH or CRITICAL.
+    std::pair<double, double> getNormalRange(VitalSign vital) const {
+        auto range = normalRanges.at(vital);
+        const AdaptiveBaseline& baseline = baselines[static_cast<size_t>(vital)];
+        if (baseline.isWarm()) {
+            range.first = std::min(range.first, baseline.lower());
+            range.second = std::max(range.second, baseline.upper());
+        }
+        return range;
+    }
+    
+    // Learns only from readings judged LOW; alarming values, MEDIUM
+    // included, never become part of the patient's normal
+    void updateBaseline(const VitalReading& reading, Priority risk) {
+        if (risk == Priority::LOW) {
+            baselines[static_cast<size_t>(reading.type)].update(reading.type, reading.value);
+        }
+    }
+    
+    const AdaptiveBaseline& getBaseline(VitalSign vital) const {
+        return baselines[static_cast<size_t>(vital)];
+    }
+    
+    // Feeds this reading's risk to the vital's K-of-N confirmation; returns
+    // the priority to alert at, or LOW while the alarm is pending
+    Priority confirmRisk(VitalSign vital, Priority risk, const ConfirmationPolicy& policy) {
+        return confirmations[static_cast<size_t>(vital)].update(risk, policy, policy.applies(vital));
+    }
+    
+    bool confirmTrend(VitalSign vital, bool trending, const ConfirmationPolicy& policy) {
+        return confirmations[static_cast<size_t>(vital)].updateTrend(trending, policy, policy.applies(vital));
+    }
+    
+    // Distance of a reading outside this patient's normal band (0 if inside)
+    double deviationFromNormal(const VitalReading& reading) {
+        auto range = getNormalRange(reading.type);
+        if (reading.value < range.first) return range.first - reading.value;
+        if (reading.value > range.second) return reading.value - range.second;
+        return 0.0;
+    }
+    
+    bool detectTrend(VitalSign vital) {
+        const HistorySlab& history = *vitalHistory;
+        size_t size = history.size(vital);
+        
+        if (size < 5) return false;
+        
+        // Simple trend detection: check if last 5 readings show consistent change
+        double sum = 0;
+        for (size_t i = size - 4; i < size; i++) {
+            sum += history.at(vital, i).value - history.at(vital, i - 1).value;
+        }
+        
+        double avgChange = sum / 4.0;
+        return std::abs(avgChange) > 2.0; // Threshold for concerning trend
+    }
+    
+    // Lock-free and safe from any thread while readings are ingested
+    std::vector<VitalReading> getRecentReadings(VitalSign vital, int count = 10) const {
+        return vitalHistory->snapshot(vital, static_cast<size_t>(std::max(0, count)));
+    }
+    
+    const HistorySlab& getHistory() const { return *vitalHistory; }
+    
+    std::unique_lock<PriorityInheritanceMutex> lockState() const {
+        return std::unique_lock<PriorityInheritanceMutex>(stateMutex.mutex);
+    }
+    
+    // Brackets one ingestion step, taken after lockState(), in the publish
+    // sequence snapshot() validates against
+    class UpdateScope {
+    public:
+        explicit UpdateScope(Patient& target) : patient(target) {
+            std::uint64_t sequence = patient.publishSequence.value.load(std::memory_order_relaxed);
+            patient.publishSequence.value.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+        ~UpdateScope() {
+            patient.publishSequence.value.fetch_add(1, std::memory_order_release);
+        }
+        UpdateScope(const UpdateScope&) = delete;
+        UpdateScope& operator=(const UpdateScope&) = delete;
+        
+    private:
+        Patient& patient;
+    };
+    
+    // Lock-free from any thread; the newest 'count' readings of each vital
+    PatientSnapshot snapshot(size_t count) const {
+        PatientSnapshot view;
+        view.patientId = patientId;
+        while (true) {
+            std::uint64_t before = publishSequence.value.load(std::memory_order_acquire);
+            if (before & 1) {
+                std::this_thread::yield();   // an ingestion step is in progress
+                continue;
+            }
+            for (size_t v = 0; v < VITAL_SIGN_COUNT; ++v) {
+                view.recent[v] = vitalHistory->snapshot(static_cast<VitalSign>(v), count);
+            }
+            view.risk = getCurrentRisk();
+            view.earlyWarningScore = getEarlyWarningScore();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (publishSequence.value.load(std::memory_order_relaxed) == before) return view;
+        }
+    }
+    
+    int getId() const { return patientId; }
+    std::string getName() const { return name; }
+    int getAge() const { return age; }
+    // Lock-free, like getRecentReadings
+    Priority getCurrentRisk() const { return currentRiskLevel.value.load(std::memory_order_relaxed); }
+    void setCurrentRisk(Priority risk) { currentRiskLevel.value.store(risk, std::memory_order_relaxed); }
+    int getEarlyWarningScore() const { return earlyWarningScore.value.load(std::memory_order_relaxed); }
+    
+    RiskLink& getRiskLink() { return riskLink; }
+    
+    const EarlyWarningScore& getEarlyWarning() const { return earlyWarning; }
+    
+    // Folds a value into the NEWS2 score and publishes the new total
+    EarlyWarningScore::Band updateEarlyWarning(VitalSign vital, double value) {
+        EarlyWarningScore::Band band = earlyWarning.update(vital, value);
+        earlyWarningScore.value.store(earlyWarning.getScore(), std::memory_order_relaxed);
+        return band;
+    }
+    
+    // Current risk is the most urgent of the latest assessment of each vital
+    // and of the aggregate early-warning band
+    void recordRisk(VitalSign vital, Priority risk) {
+        vitalRisk[static_cast<size_t>(vital)] = risk;
+        Priority composite = EarlyWarningScore::alertPriority(earlyWarning.getBand());
+        setCurrentRisk(std::min(composite, *std::min_element(std::begin(vitalRisk), std::end(vitalRisk))));
+    }
+};
+
+// Fast per-device random number generator (xoshiro256**)
+// Small, lock-free state owned by each device, so parallel simulations do
+// not serialize on rand()'s hidden global state. Seeds are expanded with
+// SplitMix64 from (simulation seed, device id) for reproducible streams.
+class Xoshiro256 {
+public:
+    explicit Xoshiro256(std::uint64_t seed = 0) {
+        reseed(seed);
+    }
+    
+    void reseed(std::uint64_t seed) {
+        for (auto& word : state) {
+            word = splitMix64(seed);
+        }
+    }
+    
+    // Independent stream per device under one simulation seed
+    static std::uint64_t streamSeed(std::uint64_t simulationSeed, int deviceId) {
+        std::uint64_t mixed = simulationSeed ^ (0x9E3779B97F4A7C15ULL * (static_cast<std::uint64_t>(deviceId) + 1));
+        return splitMix64(mixed);
+    }
+    
+    std::uint64_t next() {
+        std::uint64_t result = rotl(state[1] * 5, 7) * 9;
+        std::uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+    
+    // Uniform in [0, 1) built from the top 52 bits; branch-free bit cast,
+    // so loops over raw outputs vectorize
+    static double toUnit(std::uint64_t bits) {
+        std::uint64_t mantissa = (bits >> 12) | 0x3FF0000000000000ULL;
+        double value;
+        std::memcpy(&value, &mantissa, sizeof(value));
+        return value - 1.0;
+    }
+    
+    double nextDouble() { return toUnit(next()); }
+    
+    // Unbiased integer in [0, bound), bound > 0: Lemire's multiply-shift,
+    // redrawing the rare products whose low half falls in the biased sliver
+    std::uint32_t nextBelow(std::uint32_t bound) {
+        std::uint64_t product = (next() >> 32) * bound;
+        std::uint32_t low = static_cast<std::uint32_t>(product);
+        if (low < bound) {
+            std::uint32_t threshold = static_cast<std::uint32_t>(0u - bound) % bound;
+            while (low < threshold) {
+                product = (next() >> 32) * bound;
+                low = static_cast<std::uint32_t>(product);
+            }
+        }
+        return static_cast<std::uint32_t>(product >> 32);
+    }
+    
+private:
+    std::uint64_t state[4];
+    
+    static std::uint64_t rotl(std::uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+    
+    static std::uint64_t splitMix64(std::uint64_t& x) {
+        std::uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+};
+
+// Scripted deterioration courses for the signal model
+enum class DeteriorationProfile {
+    NONE,
+    SEPSIS,               // HR, temperature and RR up, BP down
+    RESPIRATORY_FAILURE,  // SpO2 down, RR and HR up
+    HEMORRHAGE            // BP down, HR and RR up
+};
+
+// Shared latent physiology of one patient
+// All devices of a patient read their means from here, which is what
+// correlates the vitals: a desaturation episode lowers SpO2 while raising
+// HR and respiratory rate, and a deterioration profile moves several
+// vitals together. Also carries per-patient baselines and circadian rhythm.
+// The latent state is a pure function of (simulation seed, patient, time
+// since MonitorClock::origin()), so devices may query any time in any
+// order - one generating a day ahead in bulk does not freeze what the
+// others see - and a seed reproduces a run.
+class PatientPhysiology {
+public:
+    // Seeded from MedicalDevice::getSimulationSeed() (defined after it)
+    explicit PatientPhysiology(int patientId);
+    
+    PatientPhysiology(int patientId, std::uint64_t simulationSeed)
+        : episodeSeed(Xoshiro256::streamSeed(simulationSeed ^ 0xB0D1E5ULL, patientId)),
+          profile(DeteriorationProfile::NONE), ramp(MonitorClock::duration::zero()) {
+        // Individual resting baselines within the normal adult range
+        Xoshiro256 rng(Xoshiro256::streamSeed(simulationSeed, patientId));
+        baseline[static_cast<size_t>(VitalSign::HEART_RATE)] = 68.0 + rng.nextDouble() * 16.0;
+        baseline[static_cast<size_t>(VitalSign::BLOOD_PRESSURE)] = 110.0 + rng.nextDouble() * 18.0;
+        baseline[static_cast<size_t>(VitalSign::OXYGEN_SATURATION)] = 96.5 + rng.nextDouble() * 2.0;
+        baseline[static_cast<size_t>(VitalSign::TEMPERATURE)] = 36.5 + rng.nextDouble() * 0.4;
+        baseline[static_cast<size_t>(VitalSign::RESPIRATORY_RATE)] = 13.0 + rng.nextDouble() * 4.0;
+        
+        // The ward clock's hour at the origin is shared by every patient of a seed
+        startHour = Xoshiro256(Xoshiro256::streamSeed(simulationSeed, -1)).nextDouble() * 24.0;
+    }
+    
+    void scheduleDeterioration(DeteriorationProfile course, MonitorClock::time_point start,
+                               MonitorClock::duration rampDuration) {
+        profile = course;
+        onset = start;
+        ramp = rampDuration;
+    }
+    
+    DeteriorationProfile getProfile() const { return profile; }
+    
+    // Expected value of 'vital' at time t (before device drift and noise)
+    double meanAt(VitalSign vital, MonitorClock::time_point t) const {
+        double elapsed = std::chrono::duration<double>(t - MonitorClock::origin()).count();
+        double hours = std::fmod(std::fmod(startHour + elapsed / 3600.0, 24.0) + 24.0, 24.0);
+        double hypoxia = hypoxiaAt(elapsed);
+        double sepsis = progress(DeteriorationProfile::SEPSIS, t);
+        double respiratory = progress(DeteriorationProfile::RESPIRATORY_FAILURE, t);
+        double hemorrhage = progress(DeteriorationProfile::HEMORRHAGE, t);
+        double base = baseline[static_cast<size_t>(vital)];
+        
+        switch (vital) {
+            case VitalSign::HEART_RATE:
+                return base + circadian(hours, 4.0, 16.0) + 25.0 * hypoxia
+                       + 35.0 * sepsis + 20.0 * respiratory + 45.0 * hemorrhage;
+            case VitalSign::BLOOD_PRESSURE:
+                return base + circadian(hours, 7.0, 10.0) - 45.0 * sepsis
+                       + 10.0 * respiratory - 55.0 * hemorrhage;
+            case VitalSign::OXYGEN_SATURATION:
+                return base - 12.0 * hypoxia - 3.0 * sepsis - 18.0 * respiratory - 2.0 * hemorrhage;
+            case VitalSign::TEMPERATURE:
+                return base + circadian(hours, 0.3, 18.0) + 2.3 * sepsis - 0.5 * hemorrhage;
+            case VitalSign::RESPIRATORY_RATE:
+                return base + 8.0 * hypoxia + 10.0 * sepsis + 16.0 * respiratory + 6.0 * hemorrhage;
+            default:
+                return base;
+        }
+    }
+    
+private:
+    static constexpr double EPISODE_SLOT_SECONDS = 600.0;
+    static constexpr double EPISODE_TAU_SECONDS = 30.0;
+    
+    std::uint64_t episodeSeed;
+    double baseline[VITAL_SIGN_COUNT];
+    double startHour;
+    DeteriorationProfile profile;
+    MonitorClock::time_point onset;
+    MonitorClock::duration ramp;
+    
+    // Desaturation episodes arrive about every 6 hours (each 10-minute slot
+    // holds one with probability 1/36), last 1-5 minutes and are smoothed
+    // with a 30 s first-order lag; 0..1 severity at 'elapsed' seconds
+    double hypoxiaAt(double elapsed) const {
+        long slot = static_cast<long>(std::floor(elapsed / EPISODE_SLOT_SECONDS));
+        double level = 0.0;
+        // An episode ends within 15 minutes of its slot's start and has
+        // decayed away (e^-10) 5 minutes later, so three slots cover t
+        for (long s = slot - 2; s <= slot; ++s) {
+            Xoshiro256 draw(Xoshiro256::streamSeed(episodeSeed, static_cast<int>(s)));
+            if (draw.nextDouble() >= 1.0 / 36.0) continue;
+            double start = s * EPISODE_SLOT_SECONDS + draw.nextDouble() * EPISODE_SLOT_SECONDS;
+            double end = start + 60.0 + draw.nextDouble() * 240.0;
+            double severity = 0.2 + 0.6 * draw.nextDouble();
+            if (elapsed <= start) continue;
+            double rise = 1.0 - std::exp(-(std::min(elapsed, end) - start) / EPISODE_TAU_SECONDS);
+            double decay = elapsed > end ? std::exp(-(elapsed - end) / EPISODE_TAU_SECONDS) : 1.0;
+            level += severity * rise * decay;
+        }
+        return std::min(1.0, level);
+    }
+    
+    double progress(DeteriorationProfile course, MonitorClock::time_point t) const {
+        if (profile != course || t < onset) return 0.0;
+        if (ramp <= MonitorClock::duration::zero()) return 1.0;
+        return std::min(1.0, std::chrono::duration<double>(t - onset) / ramp);
+    }
+    
+    static double circadian(double hours, double amplitude, double peakHour) {
+        return amplitude * std::cos((hours - peakHour) * (2.0 * 3.14159265358979 / 24.0));
+    }
+};
+
+// Per-device signal model
+// AR(1) (Ornstein-Uhlenbeck) drift around the physiology mean, sampled at
+// arbitrary intervals, plus white measurement noise and rare single-sample
+// sensor artifacts (motion, probe-off, cuff errors). Values are clamped to
+// physiologically possible bounds.
+class VitalSignalModel {
+public:
+    VitalSignalModel() : drift(0.0), started(false), lastArtifact(false) {}
+    
+    // Two random words per sample: 'processBits' drives the drift, 'sensorBits'
+    // the measurement noise and artifact decision
+    double sample(VitalSign vital, double mean, MonitorClock::time_point t,
+                  std::uint64_t processBits, std::uint64_t sensorBits) {
+        const Params& p = params(vital);
+        double innovation = gaussian4(processBits);
+        
+        if (!started) {
+            started = true;
+            drift = p.driftSigma * innovation;
+        } else {
+            double dt = std::max(0.0, std::chrono::duration<double>(t - lastTime).count());
+            double phi = std::exp(-dt / p.tauSeconds);
+            drift = phi * drift + p.driftSigma * std::sqrt(1.0 - phi * phi) * innovation;
+        }
+        lastTime = t;
+        
+        double value = mean + drift + p.noiseSigma * gaussian2(sensorBits >> 32);
+        
+        lastArtifact = (sensorBits & 0xFFFF) < p.artifactPer65536;
+        if (lastArtifact) {
+            double magnitude = p.artifactMin + (p.artifactMax - p.artifactMin) * ((sensorBits >> 16) & 0xFFFF) / 65535.0;
+            bool negative = p.artifactDirection < 0 || (p.artifactDirection == 0 && ((sensorBits >> 63) & 1));
+            value += negative ? -magnitude : magnitude;
+        }
+        return std::min(p.maxValue, std::max(p.minValue, value));
+    }
+    
+    bool lastSampleWasArtifact() const { return lastArtifact; }
+    
+private:
+    struct Params {
+        double tauSeconds;      // drift correlation time
+        double driftSigma;      // stationary drift spread
+        double noiseSigma;      // per-sample measurement noise
+        std::uint32_t artifactPer65536;
+        double artifactMin;
+        double artifactMax;
+        int artifactDirection;  // -1 down, +1 up, 0 either
+        double minValue;
+        double maxValue;
+    };
+    
+    double drift;
+    MonitorClock::time_point lastTime;
+    bool started;
+    bool lastArtifact;
+    
+    static const Params& params(VitalSign vital) {
+        static const Params table[VITAL_SIGN_COUNT] = {
+            {300.0,  4.0, 1.0, 131, 20.0, 60.0,  0, 20.0, 250.0},  // HEART_RATE: double counting / dropout
+            {600.0,  6.0, 3.0, 655, 15.0, 40.0,  0, 40.0, 260.0},  // BLOOD_PRESSURE: cuff motion
+            {120.0,  0.8, 0.4, 131,  5.0, 25.0, -1, 50.0, 100.0},  // OXYGEN_SATURATION: probe motion
+            {3600.0, 0.2, 0.05, 328, 3.0,  6.0, -1, 30.0,  43.0},  // TEMPERATURE: probe off skin
+            {180.0,  1.5, 0.7, 197,  5.0, 15.0,  0,  4.0,  60.0}   // RESPIRATORY_RATE: motion
+        };
+        return table[static_cast<size_t>(vital)];
+    }
+    
+    // Approximately standard normal from four 16-bit uniforms (Irwin-Hall)
+    static double gaussian4(std::uint64_t bits) {
+        double sum = static_cast<double>(bits & 0xFFFF) + static_cast<double>((bits >> 16) & 0xFFFF)
+                   + static_cast<double>((bits >> 32) & 0xFFFF) + static_cast<double>((bits >> 48) & 0xFFFF);
+        return (sum / 65536.0 - 2.0) * 1.7320508075688772;
+    }
+    
+    // Unit-variance triangular noise from two 16-bit uniforms
+    static double gaussian2(std::uint64_t bits) {
+        double sum = static_cast<double>(bits & 0xFFFF) + static_cast<double>((bits >> 16) & 0xFFFF);
+        return (sum / 65536.0 - 1.0) * 2.449489742783178;
+    }
+};
+
+// Medical Device class (simplified without threads)
+class MedicalDevice {
+private:
+    int deviceId;
+    VitalSign monitoredVital;
+    int assignedPatient;
+    bool isActive;
+    MonitorClock::duration samplingInterval;
+    Xoshiro256 rng;
+    std::shared_ptr<PatientPhysiology> physiology;
+    VitalSignalModel signal;
+    
+    inline static std::atomic<std::uint64_t> simulationSeed{0x5EEDC0FFEE123457ULL};
+    
+public:
+    MedicalDevice(int id, VitalSign vital, int patientId) 
+        : deviceId(id), monitoredVital(vital), assignedPatient(patientId), isActive(true),
+          samplingInterval(defaultSamplingInterval(vital)),
+          rng(Xoshiro256::streamSeed(simulationSeed.load(std::memory_order_relaxed), id)),
+          physiology(std::make_shared<PatientPhysiology>(patientId, simulationSeed.load(std::memory_order_relaxed))) {}
+    
+    // Devices of one patient share a physiology so their vitals correlate
+    MedicalDevice(int id, VitalSign vital, int patientId, std::shared_ptr<PatientPhysiology> shared)
+        : MedicalDevice(id, vital, patientId) {
+        physiology = std::move(shared);
+    }
+    
+    // Seed for devices created from now on; same seed + device id gives the
+    // same reading stream regardless of thread or creation order
+    static void setSimulationSeed(std::uint64_t seed) {
+        simulationSeed.store(seed, std::memory_order_relaxed);
+    }
+    
+    static std::uint64_t getSimulationSeed() {
+        return simulationSeed.load(std::memory_order_relaxed);
+    }
+    
+    VitalReading generateReading() {
+        // Two draws per reading, always, so batches replay the same stream
+        auto now = MonitorClock::now();
+        std::uint64_t processBits = rng.next();
+        std::uint64_t sensorBits = rng.next();
+        double mean = physiology->meanAt(monitoredVital, now);
+        return VitalReading(monitoredVital, signal.sample(monitoredVital, mean, now, processBits, sensorBits),
+                            assignedPatient, now);
+    }
+    
+    // Generates 'count' consecutive samples spaced by the sampling interval,
+    // starting now. Identical to 'count' generateReading() calls at those
+    // times; random words are drawn in one pass over a flat array.
+    void generateReadings(size_t count, std::vector<VitalReading>& out) {
+        std::vector<std::uint64_t> bits(count * 2);
+        for (auto& word : bits) {
+            word = rng.next();
+        }
+        
+        auto start = MonitorClock::now();
+        out.reserve(out.size() + count);
+        for (size_t i = 0; i < count; ++i) {
+            auto t = start + samplingInterval * static_cast<MonitorClock::rep>(i);
+            double mean = physiology->meanAt(monitoredVital, t);
+            out.emplace_back(monitoredVital, signal.sample(monitoredVital, mean, t, bits[2 * i], bits[2 * i + 1]),
+                             assignedPatient, t);
+        }
+    }
+    
+    // True if the last generated sample carried an injected sensor artifact
+    bool lastReadingWasArtifact() const {
+        return signal.lastSampleWasArtifact();
+    }
+    
+    std::shared_ptr<PatientPhysiology> getPhysiology() const {
+        return physiology;
+    }
+    
+    void stopMonitoring() {
+        isActive = false;
+    }
+    
+    bool isDeviceActive() const {
+        return isActive;
+    }
+    
+    int getPatientId() const {
+        return assignedPatient;
+    }
+    
+    VitalSign getVitalSign() const {
+        return monitoredVital;
+    }
+    
+    int getDeviceId() const {
+        return deviceId;
+    }
+    
+    MonitorClock::duration getSamplingInterval() const {
+        return samplingInterval;
+    }
+    
+    void setSamplingInterval(MonitorClock::duration interval) {
+        samplingInterval = interval;
+    }
+    
+    // Typical bedside reporting rates: ECG-derived HR and pleth SpO2 every
+    // second, NIBP cuff cycle every 15 minutes, temperature every 5 minutes
+    static MonitorClock::duration defaultSamplingInterval(VitalSign vital) {
+        switch (vital) {
+            case VitalSign::HEART_RATE: return std::chrono::seconds(1);
+            case VitalSign::BLOOD_PRESSURE: return std::chrono::minutes(15);
+            case VitalSign::OXYGEN_SATURATION: return std::chrono::seconds(1);
+            case VitalSign::TEMPERATURE: return std::chrono::minutes(5);
+            case VitalSign::RESPIRATORY_RATE: return std::chrono::seconds(1);
+            default: return std::chrono::seconds(1);
+        }
+    }
+};
+
+inline PatientPhysiology::PatientPhysiology(int patientId)
+    : PatientPhysiology(patientId, MedicalDevice::getSimulationSeed()) {}
+
+// Patients bucketed by current risk
+// One intrusive doubly-linked list per Priority threaded through the
+// patients themselves (their arena addresses are stable), so a risk change
+// is an O(1) unlink/relink and "top K" or "all CRITICAL beds" walk only the
+// K patients returned. Within a bucket patients are kept in the order they
+// entered it.
+class RiskIndex {
+public:
+    static constexpr size_t BUCKET_COUNT = 4;
+    
+    RiskIndex() : heads{}, tails{}, counts{} {}
+    
+    void insert(Patient& patient) {
+        RiskLink& link = patient.getRiskLink();
+        int bucket = static_cast<int>(patient.getCurrentRisk()) - 1;
+        link.bucket = bucket;
+        link.next = nullptr;
+        link.prev = tails[bucket];
+        if (tails[bucket]) {
+            tails[bucket]->getRiskLink().next = &patient;
+        } else {
+            heads[bucket] = &patient;
+        }
+        tails[bucket] = &patient;
+        counts[bucket]++;
+    }
+    
+    void remove(Patient& patient) {
+        RiskLink& link = patient.getRiskLink();
+        if (link.bucket < 0) return;
+        int bucket = link.bucket;
+        (link.prev ? link.prev->getRiskLink().next : heads[bucket]) = link.next;
+        (link.next ? link.next->getRiskLink().prev : tails[bucket]) = link.prev;
+        counts[bucket]--;
+        link = RiskLink();
+    }
+    
+    // Re-buckets the patient if its current risk changed
+    void update(Patient& patient) {
+        if (patient.getRiskLink().bucket == static_cast<int>(patient.getCurrentRisk()) - 1) return;
+        remove(patient);
+        insert(patient);
+    }
+    
+    // Visits up to 'k' patients, most urgent bucket first
+    template <typename Func>
+    void forEachMostAtRisk(size_t k, Func&& func) const {
+        for (size_t bucket = 0; bucket < BUCKET_COUNT && k > 0; ++bucket) {
+            for (Patient* p = heads[bucket]; p && k > 0; p = p->getRiskLink().next, --k) {
+                func(*p);
+            }
+        }
+    }
+    
+    template <typename Func>
+    void forEachAt(Priority risk, Func&& func) const {
+        for (Patient* p = heads[static_cast<size_t>(risk) - 1]; p; p = p->getRiskLink().next) {
+            func(*p);
+        }
+    }
+    
+    size_t count(Priority risk) const { return counts[static_cast<size_t>(risk) - 1]; }
+    
+private:
+    Patient* heads[BUCKET_COUNT];
+    Patient* tails[BUCKET_COUNT];
+    size_t counts[BUCKET_COUNT];
+};
+
+// Struct-of-arrays device table
+// Devices are grouped by the vital they measure, and each group keeps its
+// columns (ids, patients, RNG state, signal model) in parallel contiguous
+// arrays with an active bitset. A polling pass is then a tight loop per vital
+// type that skips idle devices 64 at a time instead of chasing one heap
+// object per device. Streams match a MedicalDevice with the same id.
+//
+// Device ids come from a generation-counted slot map: detaching a device
+// swap-removes its row (groups stay dense, so polling cost tracks attached
+// devices) and bumps the slot generation, so a stale id never resolves to
+// the device that later reuses the slot.
+class DeviceTable {
+public:
+    using DeviceId = int;   // generation << SLOT_BITS | slot; never negative
+    static constexpr int SLOT_BITS = 20;
+    static constexpr int GENERATION_BITS = 11;
+    static constexpr DeviceId INVALID_ID = -1;
+    
+    DeviceTable() : activeCount(0) {}
+    
+    DeviceId attach(VitalSign vital, int patientId, std::shared_ptr<PatientPhysiology> physiology) {
+        std::uint32_t slot;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            if (slots.size() == (1u << SLOT_BITS)) return INVALID_ID;
+            slot = static_cast<std::uint32_t>(slots.size());
+            slots.push_back(SlotEntry{0, 0, false});
+        }
+        SlotEntry& entry = slots[slot];
+        DeviceId id = static_cast<DeviceId>((entry.generation << SLOT_BITS) | slot);
+        
+        Group& group = groups[static_cast<size_t>(vital)];
+        std::uint32_t row = static_cast<std::uint32_t>(group.deviceIds.size());
+        group.deviceIds.push_back(id);
+        group.patientIds.push_back(patientId);
+        group.intervals.push_back(MedicalDevice::defaultSamplingInterval(vital));
+        group.rngs.emplace_back(Xoshiro256::streamSeed(MedicalDevice::getSimulationSeed(), id));
+        group.signals.emplace_back();
+        group.physiologies.push_back(std::move(physiology));
+        if (row % 64 == 0) group.activeBits.push_back(0);
+        
+        entry.vital = static_cast<std::uint32_t>(vital);
+        entry.row = row;
+        entry.attached = true;
+        setActive(id, true);
+        return id;
+    }
+    
+    // Removes the device; its id becomes stale and its slot reusable
+    bool detach(DeviceId id) {
+        if (!contains(id)) return false;
+        setActive(id, false);
+        SlotEntry& entry = slots[slotOf(id)];
+        Group& group = groups[entry.vital];
+        std::uint32_t row = entry.row;
+        std::uint32_t last = static_cast<std::uint32_t>(group.deviceIds.size() - 1);
+        
+        if (row != last) {
+            bool lastActive = testBit(group, last);
+            group.deviceIds[row] = group.deviceIds[last];
+            group.patientIds[row] = group.patientIds[last];
+            group.intervals[row] = group.intervals[last];
+            group.rngs[row] = group.rngs[last];
+            group.signals[row] = group.signals[last];
+            group.physiologies[row] = std::move(group.physiologies[last]);
+            writeBit(group, row, lastActive);
+            writeBit(group, last, false);
+            slots[slotOf(group.deviceIds[row])].row = row;
+        }
+        group.deviceIds.pop_back();
+        group.patientIds.pop_back();
+        group.intervals.pop_back();
+        group.rngs.pop_back();
+        group.signals.pop_back();
+        group.physiologies.pop_back();
+        if (last % 64 == 0) group.activeBits.pop_back();
+        
+        entry.attached = false;
+        entry.generation = (entry.generation + 1) & ((1u << GENERATION_BITS) - 1);
+        freeSlots.push_back(slotOf(id));
+        return true;
+    }
+    
+    // Moves a device to another bed; the signal restarts on the new patient
+    bool reassign(DeviceId id, int patientId, std::shared_ptr<PatientPhysiology> physiology) {
+        if (!contains(id)) return false;
+        const SlotEntry& entry = slots[slotOf(id)];
+        Group& group = groups[entry.vital];
+        group.patientIds[entry.row] = patientId;
+        group.physiologies[entry.row] = std::move(physiology);
+        group.signals[entry.row] = VitalSignalModel();
+        return true;
+    }
+    
+    bool contains(DeviceId id) const {
+        if (id < 0) return false;
+        std::uint32_t slot = slotOf(id);
+        return slot < slots.size() && slots[slot].attached
+               && slots[slot].generation == (static_cast<std::uint32_t>(id) >> SLOT_BITS);
+    }
+    
+    void setActive(DeviceId id, bool active) {
+        const SlotEntry& entry = slots[slotOf(id)];
+        Group& group = groups[entry.vital];
+        if (testBit(group, entry.row) == active) return;
+        writeBit(group, entry.row, active);
+        activeCount += active ? 1 : -1;
+    }
+    
+    bool isActive(DeviceId id) const {
+        if (!contains(id)) return false;
+        const SlotEntry& entry = slots[slotOf(id)];
+        return testBit(groups[entry.vital], entry.row);
+    }
+    
+    // One sample from a single device at 'now' (event-driven path)
+    VitalReading generate(DeviceId id, MonitorClock::time_point now) {
+        const SlotEntry& entry = slots[slotOf(id)];
+        return sample(groups[entry.vital], static_cast<VitalSign>(entry.vital), entry.row, now);
+    }
+    
+    // Samples every active device of one vital type at 'now'
+    void poll(VitalSign vital, MonitorClock::time_point now, std::vector<VitalReading>& out) {
+        Group& group = groups[static_cast<size_t>(vital)];
+        for (size_t word = 0; word < group.activeBits.size(); ++word) {
+            for (std::uint64_t bits = group.activeBits[word]; bits != 0; bits &= bits - 1) {
+                std::uint32_t row = static_cast<std::uint32_t>(word * 64 + lowestBit(bits));
+                out.push_back(sample(group, vital, row, now));
+            }
+        }
+    }
+    
+    // Visits attached devices, paused ones included, grouped by vital type
+    template <typename Func>
+    void forEachAttached(Func&& func) const {
+        for (const Group& group : groups) {
+            for (DeviceId id : group.deviceIds) {
+                func(id);
+            }
+        }
+    }
+    
+    int getPatientId(DeviceId id) const { return column(id, &Group::patientIds); }
+    VitalSign getVitalSign(DeviceId id) const { return static_cast<VitalSign>(slots[slotOf(id)].vital); }
+    MonitorClock::duration getSamplingInterval(DeviceId id) const { return column(id, &Group::intervals); }
+    
+    void setSamplingInterval(DeviceId id, MonitorClock::duration interval) {
+        const SlotEntry& entry = slots[slotOf(id)];
+        groups[entry.vital].intervals[entry.row] = interval;
+    }
+    
+    size_t size() const { return slots.size() - freeSlots.size(); }
+    size_t getActiveCount() const { return activeCount; }
+    
+private:
+    struct Group {
+        std::vector<DeviceId> deviceIds;
+        std::vector<int> patientIds;
+        std::vector<MonitorClock::duration> intervals;
+        std::vector<Xoshiro256> rngs;
+        std::vector<VitalSignalModel> signals;
+        std::vector<std::shared_ptr<PatientPhysiology>> physiologies;
+        std::vector<std::uint64_t> activeBits;
+    };
+    
+    struct SlotEntry {
+        std::uint32_t generation;
+        std::uint32_t vital : 3;
+        std::uint32_t row : 28;
+        bool attached;
+        
+        SlotEntry(std::uint32_t gen, std::uint32_t r, bool live)
+            : generation(gen), vital(0), row(r), attached(live) {}
+    };
+    
+    Group groups[VITAL_SIGN_COUNT];
+    std::vector<SlotEntry> slots;
+    std::vector<std::uint32_t> freeSlots;
+    size_t activeCount;
+    
+    static std::uint32_t slotOf(DeviceId id) {
+        return static_cast<std::uint32_t>(id) & ((1u << SLOT_BITS) - 1);
+    }
+    
+    template <typename T>
+    const T& column(DeviceId id, std::vector<T> Group::*member) const {
+        const SlotEntry& entry = slots[slotOf(id)];
+        return (groups[entry.vital].*member)[entry.row];
+    }
+    
+    static bool testBit(const Group& group, std::uint32_t row) {
+        return (group.activeBits[row / 64] >> (row % 64)) & 1;
+    }
+    
+    static void writeBit(Group& group, std::uint32_t row, bool value) {
+        std::uint64_t mask = 1ULL << (row % 64);
+        group.activeBits[row / 64] = value ? (group.activeBits[row / 64] | mask)
+                                           : (group.activeBits[row / 64] & ~mask);
+    }
+    
+    static int lowestBit(std::uint64_t bits) {
+        #if defined(__GNUC__) || defined(__clang__)
+            return __builtin_ctzll(bits);
+        #else
+            int index = 0;
+            while ((bits & 1) == 0) {
+                bits >>= 1;
+                index++;
+            }
+            return index;
+        #endif
+    }
+    
+    // Same draw order and model as MedicalDevice::generateReading
+    static VitalReading sample(Group& group, VitalSign vital, std::uint32_t row, MonitorClock::time_point now) {
+        std::uint64_t processBits = group.rngs[row].next();
+        std::uint64_t sensorBits = group.rngs[row].next();
+        double mean = group.physiologies[row]->meanAt(vital, now);
+        return VitalReading(vital, group.signals[row].sample(vital, mean, now, processBits, sensorBits),
+                            group.patientIds[row], now);
+    }
+};
+
+// False Alarm Detector
+// Everything a false-alarm detector may look at: the alert, the reading
+// that raised it (already the newest entry of the patient's history) and the
+// patient's incremental state
+struct AlarmContext {
+    const Alert& alert;
+    const VitalReading& reading;
+    const Patient& patient;
+};
+
+// Pluggable false-alarm detector
+// Detectors read a bounded tail of the history ring, the learned baselines
+// and the latest reading of other vitals, so judging an alarm costs O(1)
+// however long the patient has been monitored.
+class AlarmDetector {
+public:
+    virtual ~AlarmDetector() = default;
+    virtual const char* name() const = 0;
+    virtual bool isLikelyFalse(const AlarmContext& context) const = 0;
+    
+protected:
+    // Copies up to 'window' readings of 'vital' preceding the newest one into
+    // 'out', oldest first; returns how many were copied
+    static size_t priorValues(const HistorySlab& history, VitalSign vital, size_t window, double* out) {
+        size_t size = history.size(vital);
+        size_t count = size == 0 ? 0 : std::min(window, size - 1);
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = history.at(vital, size - 1 - count + i).value;
+        }
+        return count;
+    }
+    
+    // Median of a small scratch array (reorders it)
+    static double medianOf(double* values, size_t count) {
+        size_t mid = count / 2;
+        std::nth_element(values, values + mid, values + count);
+        if (count % 2) return values[mid];
+        return 0.5 * (values[mid] + *std::max_element(values, values + mid));
+    }
+};
+
+// Physiologically impossible jump
+// The step from the median of the previous readings is compared with the
+// most the vital can move since the last sample: a fixed allowance for
+// sensor noise plus a maximum slope. Beyond it the sensor moved, not the
+// patient. The median reference keeps an earlier artifact from making the
+// following readings look like jumps, and a step the previous sample
+// already showed has persisted, so it is no longer judged an artifact.
+class RateOfChangeDetector : public AlarmDetector {
+public:
+    static constexpr size_t REFERENCE_READINGS = 3;
+    
+    const char* name() const override { return "rate-of-change"; }
+    
+    bool isLikelyFalse(const AlarmContext& context) const override {
+        const VitalReading& reading = context.reading;
+        const HistorySlab& history = context.patient.getHistory();
+        double prior[REFERENCE_READINGS];
+        size_t count = priorValues(history, reading.type, REFERENCE_READINGS, prior);
+        if (count < REFERENCE_READINGS) return false;
+        
+        const VitalReading& previous = history.at(reading.type, history.size(reading.type) - 2);
+        double seconds = std::max(1.0, std::chrono::duration<double>(reading.timestamp - previous.timestamp).count());
+        const Limit& limit = limits(reading.type);
+        double allowed = limit.step + limit.slopePerSecond * seconds;
+        return std::abs(reading.value - medianOf(prior, count)) > allowed &&
+               std::abs(reading.value - previous.value) > allowed;
+    }
+    
+private:
+    struct Limit {
+        double step;             // noise allowance per sample
+        double slopePerSecond;   // fastest genuine change
+    };
+    
+    static const Limit& limits(VitalSign vital) {
+        static const Limit table[VITAL_SIGN_COUNT] = {
+            {15.0, 0.5},     // HEART_RATE
+            {25.0, 0.005},   // BLOOD_PRESSURE
+            {4.0, 0.3},      // OXYGEN_SATURATION
+            {1.0, 0.002},    // TEMPERATURE
+            {6.0, 0.3}       // RESPIRATORY_RATE
+        };
+        return table[static_cast<size_t>(vital)];
+    }
+};
+
+// Cross-vital consistency
+// Vitals that share physiology move together: hypoxia raises HR and RR,
+// bleeding and sepsis move HR with BP, fever raises HR. A sudden excursion
+// of one vital while every coupled vital has a fresh reading inside the
+// patient's normal range points at a probe or lead problem.
+class CrossVitalDetector : public AlarmDetector {
+public:
+    static constexpr size_t REFERENCE_READINGS = 5;
+    static constexpr double SUDDEN_NOISE_FLOORS = 4.0;
+    static constexpr std::chrono::seconds MAX_COMPANION_AGE{120};
+    
+    const char* name() const override { return "cross-vital"; }
+    
+    bool isLikelyFalse(const AlarmContext& context) const override {
+        const VitalReading& reading = context.reading;
+        const HistorySlab& history = context.patient.getHistory();
+        double prior[REFERENCE_READINGS];
+        size_t count = priorValues(history, reading.type, REFERENCE_READINGS, prior);
+        if (count < REFERENCE_READINGS) return false;
+        
+        double step = std::abs(reading.value - medianOf(prior, count));
+        if (step <= SUDDEN_NOISE_FLOORS * AdaptiveBaseline::minSpread(reading.type)) return false;
+        
+        const Companions& coupled = companions(reading.type);
+        for (size_t i = 0; i < coupled.count; ++i) {
+            VitalSign vital = coupled.vitals[i];
+            size_t size = history.size(vital);
+            if (size == 0) return false;
+            const VitalReading& latest = history.at(vital, size - 1);
+            if (reading.timestamp - latest.timestamp > MAX_COMPANION_AGE) return false;
+            auto range = context.patient.getNormalRange(vital);
+            if (latest.value < range.first || latest.value > range.second) return false;
+        }
+        return true;
+    }
+    
+private:
+    struct Companions {
+        VitalSign vitals[2];
+        size_t count;
+    };
+    
+    static const Companions& companions(VitalSign vital) {
+        static const Companions table[VITAL_SIGN_COUNT] = {
+            {{VitalSign::OXYGEN_SATURATION, VitalSign::RESPIRATORY_RATE}, 2},   // HEART_RATE
+            {{VitalSign::HEART_RATE, VitalSign::HEART_RATE}, 1},                // BLOOD_PRESSURE
+            {{VitalSign::HEART_RATE, VitalSign::RESPIRATORY_RATE}, 2},          // OXYGEN_SATURATION
+            {{VitalSign::HEART_RATE, VitalSign::HEART_RATE}, 1},                // TEMPERATURE
+            {{VitalSign::HEART_RATE, VitalSign::OXYGEN_SATURATION}, 2}          // RESPIRATORY_RATE
+        };
+        return table[static_cast<size_t>(vital)];
+    }
+};
+
+// Threshold chatter, judged robustly
+// Robust z-score of the alarming value against the median and MAD of the
+// readings before it. The judged reading is left out, and median/MAD shrug
+// off up to half the window being outliers, so a spike neither hides itself
+// nor skews the next decisions. A value within the usual scatter of a
+// centre that is itself normal is noise at the threshold. Only MEDIUM
+// alarms are judged; HIGH and above always stand.
+class RobustZScoreDetector : public AlarmDetector {
+public:
+    static constexpr size_t WINDOW = 10;
+    static constexpr size_t MIN_READINGS = 5;
+    
+    const char* name() const override { return "robust z-score"; }
+    
+    bool isLikelyFalse(const AlarmContext& context) const override {
+        if (context.alert.priority != Priority::MEDIUM) return false;
+        const VitalReading& reading = context.reading;
+        double prior[WINDOW];
+        size_t count = priorValues(context.patient.getHistory(), reading.type, WINDOW, prior);
+        if (count < MIN_READINGS) return false;
+        
+        double median = medianOf(prior, count);
+        auto range = context.patient.getNormalRange(reading.type);
+        if (median < range.first || median > range.second) return false;   // sustained, not chatter
+        
+        for (size_t i = 0; i < count; ++i) {
+            prior[i] = std::abs(prior[i] - median);
+        }
+        double spread = std::max(1.4826 * medianOf(prior, count), AdaptiveBaseline::minSpread(reading.type));
+        return std::abs(reading.value - median) / spread < 1.5;
+    }
+};
+
+// A MEDIUM alarm whose value sits inside the patient's learned band is their
+// usual state rather than a change. Values outside the absolute MEDIUM band
+// are abnormal for anyone and are never filtered.
+class LearnedBaselineDetector : public AlarmDetector {
+public:
+    const char* name() const override { return "learned baseline"; }
+    
+    bool isLikelyFalse(const AlarmContext& context) const override {
+        const VitalReading& reading = context.reading;
+        const AdaptiveBaseline& baseline = context.patient.getBaseline(reading.type);
+        return context.alert.priority == Priority::MEDIUM && baseline.isWarm() &&
+               Patient::insideMediumBand(reading.type, reading.value) && baseline.contains(reading.value);
+    }
+};
+
+// False-alarm filter: a pipeline of detectors
+// Detectors run cheapest first and the first to flag an alarm filters it,
+// which is counted against that detector. CRITICAL alarms are never
+// filtered: a missed arrest costs more than any number of false pages.
+class FalseAlarmDetector {
+public:
+    // Only the artifact detectors run by default. The chatter detectors
+    // (robust z-score, learned baseline) judge MEDIUM alarms only and are
+    // opt-in through addDetector: on deteriorating beds they also filter
+    // genuine alarms (see DetectorBenchmark).
+    FalseAlarmDetector() {
+        addDetector(std::make_unique<RateOfChangeDetector>());
+        addDetector(std::make_unique<CrossVitalDetector>());
+    }
+    
+    void addDetector(std::unique_ptr<AlarmDetector> detector) {
+        detectors.push_back(std::move(detector));
+        filtered.push_back(0);
+    }
+    
+    void clearDetectors() {
+        detectors.clear();
+        filtered.clear();
+    }
+    
+    size_t getDetectorCount() const { return detectors.size(); }
+    
+    // Detector that filtered the alarm, or nullptr if it stands
+    const AlarmDetector* judge(const AlarmContext& context) {
+        if (context.alert.priority == Priority::CRITICAL) return nullptr;
+        for (size_t i = 0; i < detectors.size(); ++i) {
+            if (detectors[i]->isLikelyFalse(context)) {
+                filtered[i]++;
+                return detectors[i].get();
+            }
+        }
+        return nullptr;
+    }
+    
+    // (detector name, alarms it filtered) in pipeline order
+    std::vector<std::pair<std::string, long>> getFilteredCounts() const {
+        std::vector<std::pair<std::string, long>> counts;
+        for (size_t i = 0; i < detectors.size(); ++i) {
+            counts.emplace_back(detectors[i]->name(), filtered[i]);
+        }
+        return counts;
+    }
+    
+    // Window-only test for callers without a patient: z-score of the newest
+    // reading against the mean and spread of the readings before it
+    static bool isLikelyFalseAlarm(const Alert& alert, const std::vector<VitalReading>& recentReadings) {
+        if (recentReadings.size() < 6) return false; // Need sufficient data
+        
+        // The judged reading must not inflate the spread it is measured against
+        const VitalReading* prior = recentReadings.data();
+        size_t count = recentReadings.size() - 1;
+        double mean = calculateMean(prior, count);
+        double stdDev = calculateStandardDeviation(prior, count, mean);
+        
+        if (stdDev == 0) return false; // Avoid division by zero
+        
+        // If current reading is within 1.5 standard deviations, might be false alarm
+        double currentValue = recentReadings.back().value;
+        double zScore = std::abs((currentValue - mean) / stdDev);
+        
+        // Different thresholds for different priority levels
+        double threshold = (alert.priority == Priority::CRITICAL) ? 2.5 : 1.5;
+        
+        return zScore < threshold;
+    }
+    
+    // A MEDIUM alert whose value sits inside the patient's learned band (and
+    // the absolute MEDIUM band) is their usual state rather than a change;
+    // other alerts fall back to the recent-window test
+    static bool isLikelyFalseAlarm(const Alert& alert, const std::vector<VitalReading>& recentReadings,
+                                   const AdaptiveBaseline& baseline) {
+        if (alert.priority == Priority::MEDIUM && !recentReadings.empty() && baseline.isWarm() &&
+            Patient::insideMediumBand(alert.relatedVital, recentReadings.back().value) &&
+            baseline.contains(recentReadings.back().value)) {
+            return true;
+        }
+        return isLikelyFalseAlarm(alert, recentReadings);
+    }
+    
+private:
+    std::vector<std::unique_ptr<AlarmDetector>> detectors;
+    std::vector<long> filtered;
+    
+    static double calculateMean(const VitalReading* readings, size_t count) {
+        double sum = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            sum += readings[i].value;
+        }
+        return sum / count;
+    }
+    
+    static double calculateStandardDeviation(const VitalReading* readings, size_t count, double mean) {
+        double variance = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            variance += std::pow(readings[i].value - mean, 2);
+        }
+        return std::sqrt(variance / count);
+    }
+};
+
+// Filter precision vs. CPU per reading
+// Replays a synthetic ward (shared physiology, drift, noise and injected
+// sensor artifacts; a fifth of beds deteriorate) through Patient risk
+// assessment, and has each detector alone and the default pipeline judge
+// every non-CRITICAL alarm. Ground truth is the device's artifact flag:
+// precision is the share of filtered alarms that were artifacts, recall the
+// share of artifact alarms filtered. Chatter detectors target noise at the
+// threshold rather than artifacts, so their safety column is the number of
+// alarms they filtered on beds that had started to deteriorate.
+class DetectorBenchmark {
+public:
+    struct Result {
+        std::string name;
+        long flagged = 0;
+        long flaggedArtifacts = 0;
+        long flaggedDeteriorating = 0;   // genuine alarms of deteriorating beds filtered
+        double nanoseconds = 0.0;        // total judging time
+        
+        double precision() const { return flagged ? static_cast<double>(flaggedArtifacts) / flagged : 0.0; }
+    };
+    
+    struct Report {
+        long readings = 0;
+        long alarms = 0;           // non-CRITICAL alarms judged
+        long artifactAlarms = 0;   // ... of which raised by an injected artifact
+        long deterioratingAlarms = 0;   // ... of which genuine, on a deteriorating bed
+        std::vector<Result> results;
+        
+        double recall(const Result& result) const {
+            return artifactAlarms ? static_cast<double>(result.flaggedArtifacts) / artifactAlarms : 0.0;
+        }
+        double nanosPerAlarm(const Result& result) const { return alarms ? result.nanoseconds / alarms : 0.0; }
+        double nanosPerReading(const Result& result) const { return readings ? result.nanoseconds / readings : 0.0; }
+    };
+    
+    static Report run(int beds, int hours, std::uint64_t seed = 1) {
+        // Each judgement is repeated so clock overhead is amortized
+        constexpr int REPEATS = 8;
+        
+        std::vector<std::unique_ptr<AlarmDetector>> single;
+        single.push_back(std::make_unique<WindowZScoreDetector>());
+        single.push_back(std::make_unique<RateOfChangeDetector>());
+        single.push_back(std::make_unique<LearnedBaselineDetector>());
+        single.push_back(std::make_unique<CrossVitalDetector>());
+        single.push_back(std::make_unique<RobustZScoreDetector>());
+        FalseAlarmDetector pipeline;
+        
+        Report report;
+        for (const auto& detector : single) {
+            report.results.push_back(Result{detector->name()});
+        }
+        report.results.push_back(Result{"default pipeline"});
+        
+        bool ownsClock = !MonitorClock::isSimulated();
+        if (ownsClock) {
+            MonitorClock::useSimulatedTime(MonitorClock::now());
+        }
+        std::uint64_t savedSeed = MedicalDevice::getSimulationSeed();
+        MedicalDevice::setSimulationSeed(seed);
+        
+        auto start = MonitorClock::now();
+        auto end = start + std::chrono::hours(hours);
+        Xoshiro256 rng(Xoshiro256::streamSeed(seed, -1));
+        
+        struct Bed {
+            std::unique_ptr<Patient> patient;
+            std::vector<MedicalDevice> devices;
+            std::vector<MonitorClock::time_point> due;
+            MonitorClock::time_point onset = MonitorClock::time_point::max();
+        };
+        std::vector<Bed> ward(static_cast<size_t>(std::max(0, beds)));
+        for (int i = 0; i < beds; ++i) {
+            Bed& bed = ward[i];
+            bed.patient = std::make_unique<Patient>(i + 1, "Bench " + std::to_string(i + 1), 60);
+            auto physiology = std::make_shared<PatientPhysiology>(i + 1);
+            if (rng.nextDouble() < 0.2) {
+                auto profile = static_cast<DeteriorationProfile>(1 + static_cast<int>(rng.nextDouble() * 3.0) % 3);
+                auto onset = std::chrono::duration_cast<MonitorClock::duration>(
+                    std::chrono::duration<double>(rng.nextDouble() * hours * 3600.0));
+                physiology->scheduleDeterioration(profile, start + onset, std::chrono::hours(2));
+                bed.onset = start + onset;
+            }
+            for (size_t v = 0; v < VITAL_SIGN_COUNT; ++v) {
+                bed.devices.emplace_back(i * static_cast<int>(VITAL_SIGN_COUNT) + static_cast<int>(v),
+                                         static_cast<VitalSign>(v), i + 1, physiology);
+                bed.due.push_back(start);
+            }
+        }
+        
+        for (auto now = start; now < end; now += std::chrono::seconds(1)) {
+            MonitorClock::advanceTo(now);
+            for (Bed& bed : ward) {
+                Patient& patient = *bed.patient;
+                for (size_t v = 0; v < bed.devices.size(); ++v) {
+                    if (bed.due[v] > now) continue;
+                    MedicalDevice& device = bed.devices[v];
+                    bed.due[v] = now + device.getSamplingInterval();
+                    
+                    VitalReading reading = device.generateReading();
+                    report.readings++;
+                    patient.addVitalReading(reading);
+                    Priority risk = patient.assessRisk(reading);
+                    patient.updateBaseline(reading, risk);
+                    if (risk == Priority::LOW || risk == Priority::CRITICAL) continue;
+                    
+                    bool artifact = device.lastReadingWasArtifact();
+                    bool deteriorating = !artifact && now >= bed.onset;
+                    report.alarms++;
+                    report.artifactAlarms += artifact;
+                    report.deterioratingAlarms += deteriorating;
+                    Alert alert(reading.patientId, risk, "bench", reading.type);
+                    AlarmContext context{alert, reading, patient};
+                    
+                    for (size_t d = 0; d <= single.size(); ++d) {
+                        bool flagged = false;
+                        auto t0 = std::chrono::steady_clock::now();
+                        for (int r = 0; r < REPEATS; ++r) {
+                            flagged = d < single.size() ? single[d]->isLikelyFalse(context)
+                                                        : pipeline.judge(context) != nullptr;
+                        }
+                        auto t1 = std::chrono::steady_clock::now();
+                        Result& result = report.results[d];
+                        result.nanoseconds += std::chrono::duration<double, std::nano>(t1 - t0).count() / REPEATS;
+                        result.flagged += flagged;
+                        result.flaggedArtifacts += flagged && artifact;
+                        result.flaggedDeteriorating += flagged && deteriorating;
+                    }
+                }
+            }
+        }
+        
+        MedicalDevice::setSimulationSeed(savedSeed);
+        if (ownsClock) {
+            MonitorClock::useRealTime();
+        }
+        return report;
+    }
+    
+    // Formats into a local stream so std::cout keeps its own flags
+    static void print(const Report& report) {
+        std::ostringstream table;
+        table << "Readings: " << report.readings << " | non-critical alarms: " << report.alarms
+              << " | raised by injected artifacts: " << report.artifactAlarms
+              << " | genuine on deteriorating beds: " << report.deterioratingAlarms << std::endl;
+        table << std::left << std::setw(20) << "Detector" << std::right
+              << std::setw(10) << "Filtered" << std::setw(11) << "Precision" << std::setw(9) << "Recall"
+              << std::setw(15) << "Deteriorating" << std::setw(11) << "ns/alarm" << std::setw(12) << "ns/reading" << std::endl;
+        table << std::fixed;
+        for (const Result& result : report.results) {
+            table << std::left << std::setw(20) << result.name << std::right
+                  << std::setw(10) << result.flagged
+                  << std::setprecision(3) << std::setw(11) << result.precision()
+                  << std::setw(9) << report.recall(result)
+                  << std::setw(15) << result.flaggedDeteriorating
+                  << std::setprecision(1) << std::setw(11) << report.nanosPerAlarm(result)
+                  << std::setprecision(2) << std::setw(12) << report.nanosPerReading(result) << std::endl;
+        }
+        std::cout << table.str();
+    }
+    
+private:
+    // The window-only static test, for comparison
+    class WindowZScoreDetector : public AlarmDetector {
+    public:
+        const char* name() const override { return "mean/stddev window"; }
+        bool isLikelyFalse(const AlarmContext& context) const override {
+            return FalseAlarmDetector::isLikelyFalseAlarm(context.alert, context.patient.getRecentReadings(context.reading.type, 10));
+        }
+    };
+};
+
+// Hierarchical timing wheel for alert deadlines
+// Four levels of 256 slots; a timer sits at the level of the highest tick
+// digit in which its expiry differs from the current tick and cascades down
+// as time advances. Nodes live in a pooled array with intrusive links, so
+// insert and cancel are O(1) and never allocate once the pool is warm.
+class TimingWheel {
+public:
+    using Handle = std::uint64_t; // generation << 32 | node index
+    static constexpr Handle INVALID_HANDLE = 0;
+    
+    explicit TimingWheel(MonitorClock::duration tickResolution = std::chrono::milliseconds(10))
+        : resolution(tickResolution), currentTick(tickOf(MonitorClock::now())), activeCount(0),
+          freeHead(NIL) {
+        for (auto& level : slots) {
+            level.fill(NIL);
+        }
+    }
+    
+    Handle schedule(MonitorClock::time_point deadline, std::uint64_t payload) {
+        std::uint32_t index = allocateNode();
+        TimerNode& node = nodes[index];
+        // Deadlines already in the past fire on the next tick
+        node.expiryTick = std::max(tickOf(deadline), currentTick + 1);
+        node.payload = payload;
+        place(index);
+        activeCount++;
+        return (static_cast<Handle>(node.generation) << 32) | index;
+    }
+    
+    // Returns false if the timer already fired or was cancelled
+    bool cancel(Handle handle) {
+        std::uint32_t index = static_cast<std::uint32_t>(handle & 0xFFFFFFFFu);
+        std::uint32_t generation = static_cast<std::uint32_t>(handle >> 32);
+        if (index >= nodes.size() || nodes[index].generation != generation || !nodes[index].linked) {
+            return false;
+        }
+        unlink(index);
+        releaseNode(index);
+        activeCount--;
+        return true;
+    }
+    
+    // Fires every timer whose expiry is at or before 'now', in tick order.
+    // onExpire(payload) may schedule or cancel other timers.
+    template <typename Callback>
+    void advanceTo(MonitorClock::time_point now, Callback&& onExpire) {
+        std::uint64_t target = tickOf(now);
+        if (activeCount == 0) {
+            // Nothing pending: jump (also re-anchors if the clock was switched)
+            currentTick = target;
+            return;
+        }
+        while (currentTick < target && activeCount > 0) {
+            currentTick++;
+            cascade();
+            
+            std::uint32_t& head = slots[0][currentTick & SLOT_MASK];
+            while (head != NIL) {
+                std::uint32_t index = head;
+                std::uint64_t payload = nodes[index].payload;
+                unlink(index);
+                releaseNode(index);
+                activeCount--;
+                onExpire(payload);
+            }
+        }
+        if (activeCount == 0) currentTick = std::max(currentTick, target);
+    }
+    
+    size_t size() const { return activeCount; }
+    
+private:
+    static constexpr int LEVELS = 4;
+    static constexpr int SLOT_BITS = 8;
+    static constexpr std::uint64_t SLOT_MASK = (1u << SLOT_BITS) - 1;
+    static constexpr std::uint32_t NIL = 0xFFFFFFFFu;
+    
+    struct TimerNode {
+        std::uint64_t expiryTick;
+        std::uint64_t payload;
+        std::uint32_t prev;
+        std::uint32_t next;
+        std::uint32_t generation;
+        std::uint8_t level;
+        std::uint8_t slot;
+        bool linked;
+    };
+    
+    MonitorClock::duration resolution;
+    std::uint64_t currentTick;
+    size_t activeCount;
+    std::uint32_t freeHead;
+    std::vector<TimerNode> nodes;
+    std::array<std::array<std::uint32_t, 1u << SLOT_BITS>, LEVELS> slots;
+    
+    std::uint64_t tickOf(MonitorClock::time_point t) const {
+        auto ticks = t.time_since_epoch() / resolution;
+        return ticks > 0 ? static_cast<std::uint64_t>(ticks) : 0;
+    }
+    
+    std::uint32_t allocateNode() {
+        if (freeHead != NIL) {
+            std::uint32_t index = freeHead;
+            freeHead = nodes[index].next;
+            return index;
+        }
+        nodes.push_back(TimerNode{0, 0, NIL, NIL, 1, 0, 0, false});
+        return static_cast<std::uint32_t>(nodes.size() - 1);
+    }
+    
+    void releaseNode(std::uint32_t index) {
+        nodes[index].generation++; // invalidates outstanding handles
+        nodes[index].next = freeHead;
+        freeHead = index;
+    }
+    
+    void place(std::uint32_t index) {
+        TimerNode& node = nodes[index];
+        std::uint64_t diff = node.expiryTick ^ currentTick;
+        int level = 0;
+        while (level < LEVELS - 1 && (diff >> (SLOT_BITS * (level + 1))) != 0) {
+            level++;
+        }
+        
+        // Timers beyond the top level's horizon simply cascade again when
+        // their slot comes around, since placement is recomputed each time
+        node.level = static_cast<std::uint8_t>(level);
+        node.slot = static_cast<std::uint8_t>((node.expiryTick >> (SLOT_BITS * level)) & SLOT_MASK);
+        std::uint32_t& head = slots[level][node.slot];
+        node.prev = NIL;
+        node.next = head;
+        if (head != NIL) nodes[head].prev = index;
+        head = index;
+        node.linked = true;
+    }
+    
+    void unlink(std::uint32_t index) {
+        TimerNode& node = nodes[index];
+        if (node.prev != NIL) {
+            nodes[node.prev].next = node.next;
+        } else {
+            slots[node.level][node.slot] = node.next;
+        }
+        if (node.next != NIL) nodes[node.next].prev = node.prev;
+        node.prev = node.next = NIL;
+        node.linked = false;
+    }
+    
+    // When a lower level wraps, redistribute the next slot of the level above
+    void cascade() {
+        for (int level = 1; level < LEVELS; ++level) {
+            if (((currentTick >> (SLOT_BITS * (level - 1))) & SLOT_MASK) != 0) break;
+            std::uint32_t& head = slots[level][(currentTick >> (SLOT_BITS * level)) & SLOT_MASK];
+            std::uint32_t index = head;
+            head = NIL;
+            while (index != NIL) {
+                std::uint32_t next = nodes[index].next;
+                place(index);
+                index = next;
+            }
+        }
+    }
+};
+
+// Outstanding (dispatched but unacknowledged) alerts
+// Sharded by patient with one mutex per shard, so acknowledgements from UI
+// threads and dispatch on the processing thread only contend when they touch
+// the same shard. Each shard indexes entries by alert id and threads them
+// into an intrusive per-patient list, keeping lookup, ack and removal O(1).
+class OutstandingAlertTable {
+public:
+    OutstandingAlertTable() : openCount(0) {}
+    
+    void insert(const std::shared_ptr<Alert>& alert, TimingWheel::Handle timer) {
+        Shard& shard = shards[Alert::shardOfAlert(alert->alertId)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        
+        auto inserted = shard.byId.emplace(alert->alertId, Entry{alert, timer, NONE, NONE});
+        if (!inserted.second) {
+            inserted.first->second.alert = alert;
+            inserted.first->second.timer = timer;
+            return;
+        }
+        linkPatient(shard, alert->alertId, inserted.first->second);
+        openCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    std::shared_ptr<Alert> find(std::uint64_t alertId) {
+        Shard& shard = shards[Alert::shardOfAlert(alertId)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.byId.find(alertId);
+        return it == shard.byId.end() ? nullptr : it->second.alert;
+    }
+    
+    // Flags an alert whose escalations ran out; it stays open (visible and
+    // acknowledgeable) but has no timer any more
+    bool markExpired(std::uint64_t alertId) {
+        Shard& shard = shards[Alert::shardOfAlert(alertId)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.byId.find(alertId);
+        if (it == shard.byId.end()) return false;
+        it->second.alert->expired = true;
+        it->second.timer = TimingWheel::INVALID_HANDLE;
+        return true;
+    }
+    
+    // Swaps in an escalated alert; fails if it was acknowledged meanwhile
+    bool replace(std::uint64_t alertId, const std::shared_ptr<Alert>& alert, TimingWheel::Handle timer) {
+        Shard& shard = shards[Alert::shardOfAlert(alertId)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.byId.find(alertId);
+        if (it == shard.byId.end()) return false;
+        it->second.alert = alert;
+        it->second.timer = timer;
+        return true;
+    }
+    
+    // Marks the alert acknowledged and removes it; 'timer' receives the
+    // pending escalation handle for the caller to cancel
+    bool acknowledge(std::uint64_t alertId, TimingWheel::Handle& timer) {
+        Shard& shard = shards[Alert::shardOfAlert(alertId)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.byId.find(alertId);
+        if (it == shard.byId.end()) return false;
+        
+        it->second.alert->acknowledged = true;
+        timer = it->second.timer;
+        eraseLocked(shard, it);
+        return true;
+    }
+    
+    // Acknowledges every open alert of one patient; returns their timers
+    std::vector<TimingWheel::Handle> acknowledgePatient(int patientId) {
+        return removePatient(patientId, &Alert::acknowledged);
+    }
+    
+    // Removes every open alert of one patient without acknowledging it
+    // (the patient left the unit); returns their timers
+    std::vector<TimingWheel::Handle> closePatient(int patientId) {
+        return removePatient(patientId, &Alert::closed);
+    }
+    
+    void remove(std::uint64_t alertId) {
+        Shard& shard = shards[Alert::shardOfAlert(alertId)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.byId.find(alertId);
+        if (it != shard.byId.end()) eraseLocked(shard, it);
+    }
+    
+    std::vector<std::shared_ptr<Alert>> openAlertsForPatient(int patientId) {
+        std::vector<std::shared_ptr<Alert>> result;
+        Shard& shard = shards[Alert::shardOfPatient(patientId)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        
+        auto head = shard.patientHeads.find(patientId);
+        std::uint64_t id = (head == shard.patientHeads.end()) ? NONE : head->second;
+        while (id != NONE) {
+            const Entry& entry = shard.byId.find(id)->second;
+            result.push_back(entry.alert);
+            id = entry.nextForPatient;
+        }
+        return result;
+    }
+    
+    size_t size() const { return openCount.load(std::memory_order_relaxed); }
+    
+private:
+    static constexpr std::uint64_t NONE = 0; // alert ids start at 1 << ID_SHARD_BITS
+    static constexpr size_t SHARD_COUNT = size_t(1) << Alert::ID_SHARD_BITS;
+    
+    struct Entry {
+        std::shared_ptr<Alert> alert;
+        TimingWheel::Handle timer;
+        std::uint64_t prevForPatient;
+        std::uint64_t nextForPatient;
+    };
+    
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::unordered_map<std::uint64_t, Entry> byId;
+        std::unordered_map<int, std::uint64_t> patientHeads;
+    };
+    
+    std::array<Shard, SHARD_COUNT> shards;
+    std::atomic<size_t> openCount;
+    
+    void linkPatient(Shard& shard, std::uint64_t alertId, Entry& entry) {
+        auto head = shard.patientHeads.emplace(entry.alert->patientId, alertId);
+        if (!head.second) {
+            entry.nextForPatient = head.first->second;
+            shard.byId.find(head.first->second)->second.prevForPatient = alertId;
+            head.first->second = alertId;
+        }
+    }
+    
+    std::vector<TimingWheel::Handle> removePatient(int patientId, std::atomic<bool> Alert::* flag) {
+        std::vector<TimingWheel::Handle> timers;
+        Shard& shard = shards[Alert::shardOfPatient(patientId)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        
+        auto head = shard.patientHeads.find(patientId);
+        std::uint64_t id = (head == shard.patientHeads.end()) ? NONE : head->second;
+        while (id != NONE) {
+            auto it = shard.byId.find(id);
+            id = it->second.nextForPatient;
+            (it->second.alert.get()->*flag) = true;
+            timers.push_back(it->second.timer);
+            eraseLocked(shard, it);
+        }
+        return timers;
+    }
+    
+    void eraseLocked(Shard& shard, std::unordered_map<std::uint64_t, Entry>::iterator it) {
+        Entry& entry = it->second;
+        if (entry.prevForPatient != NONE) {
+            shard.byId.find(entry.prevForPatient)->second.nextForPatient = entry.nextForPatient;
+        } else if (entry.nextForPatient != NONE) {
+            shard.patientHeads[entry.alert->patientId] = entry.nextForPatient;
+        } else {
+            shard.patientHeads.erase(entry.alert->patientId);
+        }
+        if (entry.nextForPatient != NONE) {
+            shard.byId.find(entry.nextForPatient)->second.prevForPatient = entry.prevForPatient;
+        }
+        shard.byId.erase(it);
+        openCount.fetch_sub(1, std::memory_order_relaxed);
+    }
+};
+
+// Lock-free latency histogram for concurrent recorders
+// Log-linear buckets, eight per power of two (within 12.5%), from 1 ns to
+// about 18 minutes; percentiles report the upper bound of their bucket.
+class LatencyHistogram {
+public:
+    LatencyHistogram() : total(0), maximum(0) {
+        for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+    }
+    
+    void record(std::chrono::nanoseconds latency) {
+        std::uint64_t ns = static_cast<std::uint64_t>(std::max<std::int64_t>(0, latency.count()));
+        buckets[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(1, std::memory_order_relaxed);
+        std::uint64_t seen = maximum.load(std::memory_order_relaxed);
+        while (ns > seen && !maximum.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {}
+    }
+    
+    std::uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    std::chrono::nanoseconds max() const {
+        return std::chrono::nanoseconds(maximum.load(std::memory_order_relaxed));
+    }
+    
+    // Latency at or below which a fraction q of the samples fall
+    std::chrono::nanoseconds percentile(double q) const {
+        std::uint64_t samples = count();
+        if (samples == 0) return std::chrono::nanoseconds(0);
+        std::uint64_t rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(q * samples)));
+        std::uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank) return std::min(std::chrono::nanoseconds(upperBound(i)), max());
+        }
+        return max();
+    }
+    
+private:
+    static constexpr int SUB_BITS = 3;
+    static constexpr size_t SUB_BUCKETS = 1 << SUB_BITS;
+    static constexpr size_t BUCKETS = (40 - SUB_BITS + 2) * SUB_BUCKETS;   // up to 2^40 ns
+    
+    std::atomic<std::uint64_t> buckets[BUCKETS];
+    std::atomic<std::uint64_t> total;
+    std::atomic<std::uint64_t> maximum;
+    
+    static size_t bucketOf(std::uint64_t ns) {
+        if (ns < SUB_BUCKETS) return static_cast<size_t>(ns);
+        int exponent = 0;
+        while ((ns >> (exponent + 1)) != 0) ++exponent;
+        size_t index = (exponent - SUB_BITS + 1) * SUB_BUCKETS + ((ns >> (exponent - SUB_BITS)) & (SUB_BUCKETS - 1));
+        return std::min(index, BUCKETS - 1);
+    }
+    
+    static std::int64_t upperBound(size_t index) {
+        if (index < SUB_BUCKETS) return static_cast<std::int64_t>(index);
+        int exponent = static_cast<int>(index / SUB_BUCKETS) + SUB_BITS - 1;
+        std::uint64_t sub = index % SUB_BUCKETS;
+        return static_cast<std::int64_t>(((SUB_BUCKETS + sub + 1) << (exponent - SUB_BITS)) - 1);
+    }
+};
+
+// Where an AlertDispatcher's CRITICAL lane runs
+// All of it is best effort: the dispatcher reports what the OS granted
+// (SCHED_FIFO and mlockall usually need CAP_SYS_NICE / CAP_IPC_LOCK).
+// mlockall is process-wide and is not undone when the dispatcher goes.
+struct DispatchLaneOptions {
+    std::vector<int> criticalCpus;   // pin the CRITICAL lane here, pool elsewhere
+    bool realtime = false;           // SCHED_FIFO for the CRITICAL lane
+    int realtimePriority = 50;
+    bool lockMemory = false;         // no page faults on the CRITICAL path
+};
+
+// Priority-partitioned pool that runs alert handlers off the processing thread
+// CRITICAL alerts have a reserved lane thread that never runs other work;
+// it can be pinned to dedicated CPUs (the pool is then kept off them) and
+// given SCHED_FIFO, so a slow LOW handler (paging, EHR write) or
+// maintenance work cannot delay them. The rest run on a work-stealing
+// pool: each worker owns one deque per lane (HIGH, MEDIUM, LOW, then
+// background maintenance) and scans the lanes most urgent first across the
+// whole pool. Within a lane it takes its own oldest job, else steals from
+// another worker's tail, so a queued HIGH job is never left behind a
+// worker's own LOW one. Queue wait is recorded per lane.
+class AlertDispatcher {
+public:
+    using Handler = std::function<void(const std::shared_ptr<Alert>&)>;
+    
+    static constexpr size_t LANE_COUNT = 5;   // CRITICAL, HIGH, MEDIUM, LOW, background
+    static constexpr size_t BACKGROUND_LANE = LANE_COUNT - 1;
+    
+    AlertDispatcher(size_t workerCount, Handler alertHandler, const DispatchLaneOptions& laneOptions = DispatchLaneOptions())
+        : handler(std::move(alertHandler)), options(laneOptions), queued(0), pending(0), steals(0),
+          nextQueue(0), stopping(false) {
+        workerCount = std::max<size_t>(1, workerCount);
+        for (size_t i = 0; i < workerCount; ++i) {
+            queues.push_back(std::make_unique<WorkerQueue>());
+        }
+        for (auto& count : handled) count.store(0);
+        fastLane = std::thread([this]() { runFastLane(); });
+        for (size_t i = 0; i < workerCount; ++i) {
+            workers.emplace_back([this, i]() { runWorker(i); });
+        }
+        applyPlacement();
+    }
+    
+    // Finishes every submitted job before the threads exit
+    ~AlertDispatcher() {
+        waitIdle();
+        stopping.store(true);
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wake.notify_all();
+        {
+            std::lock_guard<std::mutex> lock(fastMutex);
+        }
+        fastWake.notify_all();
+        for (auto& worker : workers) worker.join();
+        fastLane.join();
+    }
+    
+    AlertDispatcher(const AlertDispatcher&) = delete;
+    AlertDispatcher& operator=(const AlertDispatcher&) = delete;
+    
+    void submit(std::shared_ptr<Alert> alert) {
+        size_t lane = laneOf(alert->priority);
+        Job job{std::move(alert), nullptr, std::chrono::steady_clock::now()};
+        pending.fetch_add(1, std::memory_order_relaxed);
+        if (lane == 0) {
+            {
+                std::lock_guard<std::mutex> lock(fastMutex);
+                fastQueue.push_back(std::move(job));
+            }
+            fastWake.notify_one();
+            return;
+        }
+        enqueue(lane, std::move(job));
+    }
+    
+    // Maintenance work (history compaction, log and archive flushes) that
+    // runs on the pool below LOW and never on the CRITICAL lane
+    void submitBackground(std::function<void()> task) {
+        pending.fetch_add(1, std::memory_order_relaxed);
+        enqueue(BACKGROUND_LANE, Job{nullptr, std::move(task), std::chrono::steady_clock::now()});
+    }
+    
+    // Drops alert jobs of one patient that no thread has picked up yet;
+    // returns how many were dropped
+    size_t dropPatient(int patientId) {
+        auto drop = [patientId](std::deque<Job>& jobs) {
+            auto kept = std::remove_if(jobs.begin(), jobs.end(), [patientId](const Job& job) {
+                return job.alert && job.alert->patientId == patientId;
+            });
+            size_t count = static_cast<size_t>(jobs.end() - kept);
+            jobs.erase(kept, jobs.end());
+            return count;
+        };
+        size_t dropped = 0;
+        {
+            std::lock_guard<std::mutex> lock(fastMutex);
+            dropped += drop(fastQueue);
+        }
+        size_t fromPool = 0;
+        for (auto& queue : queues) {
+            std::lock_guard<std::mutex> lock(queue->mutex);
+            for (size_t i = 0; i < POOL_LANES; ++i) {
+                fromPool += drop(queue->lanes[i]);
+                queue->sizes[i].store(queue->lanes[i].size(), std::memory_order_relaxed);
+            }
+        }
+        queued.fetch_sub(static_cast<long>(fromPool), std::memory_order_relaxed);
+        dropped += fromPool;
+        if (dropped > 0 && pending.fetch_sub(static_cast<long>(dropped), std::memory_order_acq_rel) == static_cast<long>(dropped)) {
+            std::lock_guard<std::mutex> lock(idleMutex);
+            idle.notify_all();
+        }
+        return dropped;
+    }
+    
+    // Blocks until every submitted job has run
+    void waitIdle() {
+        std::unique_lock<std::mutex> lock(idleMutex);
+        idle.wait(lock, [this]() { return pending.load(std::memory_order_acquire) == 0; });
+    }
+    
+    size_t getWorkerCount() const { return workers.size(); }
+    long getSteals() const { return steals.load(std::memory_order_relaxed); }
+    long getHandled(Priority priority) const {
+        return handled[laneOf(priority)].load(std::memory_order_relaxed);
+    }
+    long getBackgroundHandled() const { return handled[BACKGROUND_LANE].load(std::memory_order_relaxed); }
+    const std::string& getPlacement() const { return placement; }
+    
+    // Time from submit until a thread picked the job up, per lane
+    const LatencyHistogram& getQueueLatency(size_t lane) const { return queueLatency[lane]; }
+    const LatencyHistogram& getQueueLatency(Priority priority) const { return queueLatency[laneOf(priority)]; }
+    
+    static const char* laneName(size_t lane) {
+        static const char* const names[LANE_COUNT] = {"CRITICAL", "HIGH", "MEDIUM", "LOW", "Background"};
+        return names[lane];
+    }
+    
+    void printLaneLatency(std::ostream& out) const {
+        std::ostringstream table;
+        table << "Dispatch lanes (" << placement << "), queue wait in microseconds:" << std::endl;
+        table << "  " << std::left << std::setw(12) << "Lane" << std::right << std::setw(10) << "Jobs"
+              << std::setw(12) << "p50" << std::setw(12) << "p99" << std::setw(12) << "max" << std::endl;
+        table << std::fixed << std::setprecision(1);
+        for (size_t lane = 0; lane < LANE_COUNT; ++lane) {
+            const LatencyHistogram& latency = queueLatency[lane];
+            auto micros = [](std::chrono::nanoseconds ns) { return ns.count() / 1000.0; };
+            table << "  " << std::left << std::setw(12) << laneName(lane) << std::right
+                  << std::setw(10) << latency.count()
+                  << std::setw(12) << micros(latency.percentile(0.50))
+                  << std::setw(12) << micros(latency.percentile(0.99))
+                  << std::setw(12) << micros(latency.max()) << std::endl;
+        }
+        out << table.str();
+    }
+    
+private:
+    static constexpr size_t POOL_LANES = LANE_COUNT - 1;   // all but CRITICAL
+    
+    // An alert for the handler, or a background task
+    struct Job {
+        std::shared_ptr<Alert> alert;
+        std::function<void()> task;
+        std::chrono::steady_clock::time_point submitted;   // wall time; MonitorClock may be simulated
+    };
+    
+    struct alignas(64) WorkerQueue {
+        std::mutex mutex;
+        std::deque<Job> lanes[POOL_LANES];
+        std::atomic<size_t> sizes[POOL_LANES];   // written under the lock, read without it to skip empty lanes
+        
+        WorkerQueue() {
+            for (auto& size : sizes) size.store(0, std::memory_order_relaxed);
+        }
+    };
+    
+    Handler handler;
+    DispatchLaneOptions options;
+    std::string placement;
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<long> queued;   // jobs waiting in worker queues
+    
+    std::thread fastLane;
+    std::mutex fastMutex;
+    std::condition_variable fastWake;
+    std::deque<Job> fastQueue;
+    
+    std::atomic<long> pending;  // submitted and not yet run
+    std::mutex idleMutex;
+    std::condition_variable idle;
+    std::atomic<long> handled[LANE_COUNT];
+    LatencyHistogram queueLatency[LANE_COUNT];
+    std::atomic<long> steals;
+    std::atomic<size_t> nextQueue;
+    std::atomic<bool> stopping;
+    
+    static size_t laneOf(Priority priority) { return static_cast<size_t>(priority) - 1; }
+    
+    void enqueue(size_t lane, Job job) {
+        WorkerQueue& queue = *queues[nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.lanes[lane - 1].push_back(std::move(job));
+            queue.sizes[lane - 1].store(queue.lanes[lane - 1].size(), std::memory_order_relaxed);
+        }
+        {
+            // Taking the sleep lock orders this against a worker about to wait
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            queued.fetch_add(1, std::memory_order_release);
+        }
+        wake.notify_one();
+    }
+    
+    // One job of a pool lane of 'queue', from the front for its owner and
+    // from the back for a thief
+    static bool take(WorkerQueue& queue, size_t poolLane, bool fromBack, Job& job) {
+        if (queue.sizes[poolLane].load(std::memory_order_relaxed) == 0) return false;
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        auto& jobs = queue.lanes[poolLane];
+        if (jobs.empty()) return false;
+        if (fromBack) {
+            job = std::move(jobs.back());
+            jobs.pop_back();
+        } else {
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        queue.sizes[poolLane].store(jobs.size(), std::memory_order_relaxed);
+        return true;
+    }
+    
+    // Lane-major: every queue's HIGH jobs before anyone's MEDIUM, and so on
+    bool next(size_t self, Job& job, size_t& lane) {
+        for (size_t i = 0; i < POOL_LANES; ++i) {
+            lane = i + 1;
+            if (take(*queues[self], i, false, job)) return true;
+            for (size_t v = 1; v < queues.size(); ++v) {
+                if (take(*queues[(self + v) % queues.size()], i, true, job)) {
+                    steals.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+    
+    void runWorker(size_t self) {
+        Job job;
+        size_t lane = 0;
+        while (true) {
+            if (next(self, job, lane)) {
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                run(job, lane);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [this]() { return stopping || queued.load(std::memory_order_acquire) > 0; });
+            if (stopping && queued.load(std::memory_order_acquire) == 0) return;
+        }
+    }
+    
+    void runFastLane() {
+        std::unique_lock<std::mutex> lock(fastMutex);
+        while (true) {
+            fastWake.wait(lock, [this]() { return stopping || !fastQueue.empty(); });
+            if (fastQueue.empty()) return;   // stopping
+            Job job = std::move(fastQueue.front());
+            fastQueue.pop_front();
+            lock.unlock();
+            run(job, 0);
+            lock.lock();
+        }
+    }
+    
+    void run(Job& job, size_t lane) {
+        queueLatency[lane].record(std::chrono::steady_clock::now() - job.submitted);
+        try {
+            if (job.alert) {
+                handler(job.alert);
+            } else {
+                job.task();
+            }
+        } catch (...) {
+            // A failing handler must not take the worker down
+        }
+        job = Job();
+        handled[lane].fetch_add(1, std::memory_order_relaxed);
+        if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(idleMutex);
+            idle.notify_all();
+        }
+    }
+    
+    // Applies the lane options once the threads exist and records the outcome
+    void applyPlacement() {
+        std::vector<std::string> applied;
+#ifdef LANE_PLACEMENT
+        if (!options.criticalCpus.empty()) {
+            cpu_set_t critical;
+            CPU_ZERO(&critical);
+            std::string cpus;
+            for (int cpu : options.criticalCpus) {
+                if (cpu < 0 || cpu >= CPU_SETSIZE) continue;
+                CPU_SET(cpu, &critical);
+                cpus += (cpus.empty() ? "" : ",") + std::to_string(cpu);
+            }
+            int error = pthread_setaffinity_np(fastLane.native_handle(), sizeof(critical), &critical);
+            if (error != 0) {
+                applied.push_back("CRITICAL lane not pinned (" + std::string(std::strerror(error)) + ")");
+            } else {
+                applied.push_back("CRITICAL lane on CPU " + cpus);
+                cpu_set_t pool;
+                if (sched_getaffinity(0, sizeof(pool), &pool) == 0) {
+                    CPU_AND(&critical, &critical, &pool);
+                    CPU_XOR(&pool, &pool, &critical);
+                    if (CPU_COUNT(&pool) > 0) {
+                        for (auto& worker : workers) {
+                            pthread_setaffinity_np(worker.native_handle(), sizeof(pool), &pool);
+                        }
+                        applied.push_back("pool on " + std::to_string(CPU_COUNT(&pool)) + " other CPU(s)");
+                    } else {
+                        applied.push_back("pool shares it (no other CPU)");
+                    }
+                }
+            }
+        }
+        if (options.realtime) {
+            sched_param param{};
+            param.sched_priority = options.realtimePriority;
+            int error = pthread_setschedparam(fastLane.native_handle(), SCHED_FIFO, &param);
+            applied.push_back(error == 0 ? "SCHED_FIFO " + std::to_string(options.realtimePriority)
+                                         : "SCHED_FIFO denied (" + std::string(std::strerror(error)) + ")");
+        }
+        if (options.lockMemory) {
+            applied.push_back(mlockall(MCL_CURRENT | MCL_FUTURE) == 0
+                                  ? "memory locked"
+                                  : "mlockall denied (" + std::string(std::strerror(errno)) + ")");
+        }
+#else
+        if (!options.criticalCpus.empty() || options.realtime || options.lockMemory) {
+            applied.push_back("CPU pinning and real-time scheduling unsupported here");
+        }
+#endif
+        for (const auto& part : applied) {
+            placement += (placement.empty() ? "" : "; ") + part;
+        }
+        if (placement.empty()) placement = "default scheduling";
+    }
+};
+
+// Synthetic overload for checking CRITICAL lane isolation
+// A producer ticks every millisecond and offers the pool about twice the
+// HIGH/MEDIUM/LOW handler work its workers can do, plus background
+// maintenance, while CRITICAL alerts arrive every few ticks. Handlers
+// busy-wait to stand in for paging and EHR writes. With isolation the
+// CRITICAL queue wait stays near thread wake-up latency while the other
+// lanes' waits grow with the backlog.
+class LaneOverloadBenchmark {
+public:
+    struct Report {
+        std::string placement;
+        double offeredLoad = 0.0;   // pool work offered per unit of pool capacity
+        std::uint64_t jobs[AlertDispatcher::LANE_COUNT] = {};
+        std::chrono::nanoseconds p50[AlertDispatcher::LANE_COUNT] = {};
+        std::chrono::nanoseconds p99[AlertDispatcher::LANE_COUNT] = {};
+        std::chrono::nanoseconds max[AlertDispatcher::LANE_COUNT] = {};
+    };
+    
+    static Report run(size_t workers, std::chrono::milliseconds duration,
+                      const DispatchLaneOptions& lanes = DispatchLaneOptions()) {
+        using namespace std::chrono;
+        workers = std::max<size_t>(1, workers);
+        // Per-job cost by lane, and once the offer stops the backlog is
+        // drained without the work so it only adds queue wait
+        static const microseconds COST[AlertDispatcher::LANE_COUNT] = {
+            microseconds(50), microseconds(200), microseconds(500), microseconds(1000), microseconds(2000)};
+        std::atomic<bool> draining(false);
+        auto work = [&draining](microseconds cost) {
+            auto until = steady_clock::now() + cost;
+            while (!draining.load(std::memory_order_relaxed) && steady_clock::now() < until) {}
+        };
+        
+        Report report;
+        {
+            AlertDispatcher dispatcher(workers, [&](const std::shared_ptr<Alert>& alert) {
+                work(COST[static_cast<size_t>(alert->priority) - 1]);
+            }, lanes);
+            report.placement = dispatcher.getPlacement();
+            
+            // Per tick: 2 x workers LOW, one HIGH; MEDIUM every other tick,
+            // background every fourth and CRITICAL every fifth
+            microseconds offered(0);
+            auto start = steady_clock::now();
+            for (long tick = 0; steady_clock::now() - start < duration; ++tick) {
+                for (size_t i = 0; i < 2 * workers; ++i) {
+                    dispatcher.submit(makeAlert(Priority::LOW, static_cast<int>(i)));
+                    offered += COST[3];
+                }
+                dispatcher.submit(makeAlert(Priority::HIGH, 0));
+                offered += COST[1];
+                if (tick % 2 == 0) {
+                    dispatcher.submit(makeAlert(Priority::MEDIUM, 0));
+                    offered += COST[2];
+                }
+                if (tick % 4 == 0) {
+                    dispatcher.submitBackground([&work]() { work(COST[AlertDispatcher::BACKGROUND_LANE]); });
+                    offered += COST[AlertDispatcher::BACKGROUND_LANE];
+                }
+                if (tick % 5 == 0) dispatcher.submit(makeAlert(Priority::CRITICAL, 0));
+                std::this_thread::sleep_until(start + milliseconds(tick + 1));
+            }
+            auto elapsed = duration_cast<microseconds>(steady_clock::now() - start);
+            report.offeredLoad = static_cast<double>(offered.count()) / (elapsed.count() * workers);
+            draining.store(true);
+            dispatcher.waitIdle();
+            
+            for (size_t lane = 0; lane < AlertDispatcher::LANE_COUNT; ++lane) {
+                const LatencyHistogram& latency = dispatcher.getQueueLatency(lane);
+                report.jobs[lane] = latency.count();
+                report.p50[lane] = latency.percentile(0.50);
+                report.p99[lane] = latency.percentile(0.99);
+                report.max[lane] = latency.max();
+            }
+        }
+        return report;
+    }
+    
+    static void print(const Report& report) {
+        std::ostringstream table;
+        table << "Placement: " << report.placement << std::endl;
+        table << std::fixed << std::setprecision(1)
+              << "Offered load: " << report.offeredLoad << "x pool capacity" << std::endl;
+        table << std::left << std::setw(12) << "Lane" << std::right << std::setw(10) << "Jobs"
+              << std::setw(14) << "p50 (us)" << std::setw(14) << "p99 (us)" << std::setw(14) << "max (us)" << std::endl;
+        for (size_t lane = 0; lane < AlertDispatcher::LANE_COUNT; ++lane) {
+            table << std::left << std::setw(12) << AlertDispatcher::laneName(lane) << std::right
+                  << std::setw(10) << report.jobs[lane]
+                  << std::setw(14) << report.p50[lane].count() / 1000.0
+                  << std::setw(14) << report.p99[lane].count() / 1000.0
+                  << std::setw(14) << report.max[lane].count() / 1000.0 << std::endl;
+        }
+        std::cout << table.str();
+    }
+    
+private:
+    static std::shared_ptr<Alert> makeAlert(Priority priority, int patientId) {
+        return std::make_shared<Alert>(patientId, priority, "Synthetic overload", VitalSign::HEART_RATE);
+    }
+};
+
+// Ordered output written off the producing thread
+// Producers append encoded chunks; each append schedules a drain through
+// the runner (the dispatcher's background lane), and whichever drain runs
+// first writes everything queued so far. Drains are serialized on their own
+// lock, so chunks reach the stream in append order, and a producer never
+// waits on stream I/O. With no runner, chunks are written inline. close()
+// writes what is left on the calling thread and detaches the stream, so
+// drains still queued afterwards find nothing to do; it does not use the
+// runner, so it is safe while the runner's owner is being torn down.
+class BackgroundSink : public std::enable_shared_from_this<BackgroundSink> {
+public:
+    using Runner = std::function<void(std::function<void()>)>;
+    
+    BackgroundSink(std::ostream* stream, Runner backgroundRunner)
+        : out(stream), runner(std::move(backgroundRunner)) {}
+    
+    void write(std::string chunk) {
+        if (chunk.empty()) return;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            chunks.push_back(std::move(chunk));
+        }
+        if (runner) {
+            runner([self = shared_from_this()]() { self->drain(); });
+        } else {
+            drain();
+        }
+    }
+    
+    void close(const std::string& last = std::string()) {
+        drain();
+        std::lock_guard<std::mutex> lock(writeMutex);
+        if (!out) return;
+        out->write(last.data(), static_cast<std::streamsize>(last.size()));
+        out->flush();
+        out = nullptr;
+    }
+    
+private:
+    std::ostream* out;
+    Runner runner;
+    std::mutex queueMutex;       // guards chunks; held only to swap them out
+    std::mutex writeMutex;       // serializes drains and guards out
+    std::vector<std::string> chunks;
+    
+    void drain() {
+        std::lock_guard<std::mutex> writeLock(writeMutex);
+        std::vector<std::string> ready;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            ready.swap(chunks);
+        }
+        if (!out) return;
+        for (const std::string& chunk : ready) {
+            out->write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        }
+    }
+};
+
+// Alert Processor
+// Dequeues in priority order on the calling thread; handlers run there too,
+// or on an AlertDispatcher pool once dispatch workers are configured.
+class AlertProcessor {
+private:
+    std::priority_queue<std::shared_ptr<Alert>, std::vector<std::shared_ptr<Alert>>, AlertComparator> alertQueue;
+    long totalAlertsProcessed;
+    long falseAlarmsFiltered;
+    bool verbose;
+    
+    // Escalation timers for alerts that are not yet acknowledged. The wheel
+    // has its own small lock so acknowledgements from other threads can
+    // cancel timers; lock order is always wheel before table shard.
+    TimingWheel escalationWheel;
+    std::mutex wheelMutex;
+    OutstandingAlertTable outstanding;
+    long totalEscalations;
+    long expiredUnacknowledged;
+    int maxEscalations;
+    
+    // Deterministic, wall-clock-free log of dispatched alerts for diffing
+    // runs. Lines are formatted in dequeue order and written in chunks on
+    // the background lane.
+    static constexpr size_t ALERT_LOG_CHUNK = 16 * 1024;
+    std::shared_ptr<BackgroundSink> alertLog;
+    std::string alertLogBuffer;
+    MonitorClock::time_point alertLogEpoch;
+    
+    // Handlers: console output is serialized, the external hook is not.
+    // The dispatcher is declared last so it drains before the rest goes.
+    std::function<void(const Alert&)> alertHandler;
+    std::mutex outputMutex;
+    std::unique_ptr<AlertDispatcher> dispatcher;
+    
+public:
+    AlertProcessor() : totalAlertsProcessed(0), falseAlarmsFiltered(0), verbose(true),
+                       totalEscalations(0), expiredUnacknowledged(0), maxEscalations(3) {}
+    
+    ~AlertProcessor() {
+        closeAlertLog();
+    }
+    
+    void addAlert(std::shared_ptr<Alert> alert) {
+        pollEscalations();
+        alertQueue.push(alert);
+        armEscalation(alert);
+    }
+    
+    // Bulk enqueue: one escalation poll and one wheel lock for the batch
+    void addAlerts(const std::vector<std::shared_ptr<Alert>>& alerts) {
+        if (alerts.empty()) return;
+        pollEscalations();
+        
+        std::vector<TimingWheel::Handle> timers(alerts.size());
+        {
+            std::lock_guard<std::mutex> lock(wheelMutex);
+            for (size_t i = 0; i < alerts.size(); ++i) {
+                const Alert& alert = *alerts[i];
+                timers[i] = escalationWheel.schedule(alert.createdAt + responseBudget(alert.priority), alert.alertId);
+            }
+        }
+        for (size_t i = 0; i < alerts.size(); ++i) {
+            alertQueue.push(alerts[i]);
+            outstanding.insert(alerts[i], timers[i]);
+        }
+    }
+    
+    // Thread-safe; acknowledging cancels the pending escalation timer in O(1)
+    bool acknowledgeAlert(std::uint64_t alertId) {
+        TimingWheel::Handle timer;
+        if (!outstanding.acknowledge(alertId, timer)) return false;
+        
+        std::lock_guard<std::mutex> lock(wheelMutex);
+        escalationWheel.cancel(timer);
+        return true;
+    }
+    
+    // Thread-safe; returns the number of alerts acknowledged
+    size_t acknowledgePatientAlerts(int patientId) {
+        std::vector<TimingWheel::Handle> timers = outstanding.acknowledgePatient(patientId);
+        
+        std::lock_guard<std::mutex> lock(wheelMutex);
+        for (auto timer : timers) {
+            escalationWheel.cancel(timer);
+        }
+        return timers.size();
+    }
+    
+    // Discharge path: drops the patient's open alerts and escalation timers
+    // without acknowledging them, and drops notifications still queued for
+    // them; returns the number of open alerts closed. O(open alerts of the
+    // patient): closed alerts still in the priority queue are skipped when
+    // dequeued.
+    size_t closePatientAlerts(int patientId) {
+        std::vector<TimingWheel::Handle> timers = outstanding.closePatient(patientId);
+        {
+            std::lock_guard<std::mutex> lock(wheelMutex);
+            for (auto timer : timers) {
+                escalationWheel.cancel(timer);
+            }
+        }
+        if (dispatcher) dispatcher->dropPatient(patientId);
+        return timers.size();
+    }
+    
+    std::vector<std::shared_ptr<Alert>> getOpenAlerts(int patientId) {
+        return outstanding.openAlertsForPatient(patientId);
+    }
+    
+    // Current (possibly escalated) alert object for an open id, else null
+    std::shared_ptr<Alert> findOpenAlert(std::uint64_t alertId) {
+        return outstanding.find(alertId);
+    }
+    
+    // Fires every escalation deadline that has passed on MonitorClock
+    void pollEscalations() {
+        std::lock_guard<std::mutex> lock(wheelMutex);
+        escalationWheel.advanceTo(MonitorClock::now(), [this](std::uint64_t alertId) {
+            escalate(alertId);
+        });
+    }
+    
+    void processNextAlert() {
+        if (!alertQueue.empty()) {
+            auto alert = alertQueue.top();
+            alertQueue.pop();
+            if (alert->closed) return;   // its patient was released
+            logDispatch(*alert);
+            totalAlertsProcessed++;
+            if (dispatcher) {
+                // Handlers get a copy taken at dequeue: ingestion keeps
+                // folding repeats into the open alert while they run
+                dispatcher->submit(std::make_shared<Alert>(*alert));
+            } else {
+                handleAlert(alert);
+            }
+        }
+    }
+    
+    // Runs handlers on a pool of 'workers' threads plus a CRITICAL lane
+    // placed per 'lanes', so processAllAlerts returns once alerts are
+    // dequeued; 0 goes back to handling on the calling thread. Pending
+    // handlers finish first.
+    void setDispatchWorkers(size_t workers, const DispatchLaneOptions& lanes = DispatchLaneOptions()) {
+        dispatcher.reset();
+        if (workers > 0) {
+            dispatcher = std::make_unique<AlertDispatcher>(workers, [this](const std::shared_ptr<Alert>& alert) {
+                handleAlert(alert);
+            }, lanes);
+        }
+    }
+    
+    // Maintenance off the CRITICAL path: the dispatcher's background lane,
+    // or inline when handlers run on the calling thread
+    void runInBackground(std::function<void()> task) {
+        if (dispatcher) {
+            dispatcher->submitBackground(std::move(task));
+        } else {
+            task();
+        }
+    }
+    
+    size_t getDispatchWorkers() const { return dispatcher ? dispatcher->getWorkerCount() : 0; }
+    const AlertDispatcher* getDispatcher() const { return dispatcher.get(); }
+    
+    // Side effects of a dispatched alert (paging, EHR writes, wall
+    // displays); runs on a pool thread once dispatch workers are set, so it
+    // must be thread-safe, and then sees a copy of the alert taken at
+    // dequeue. Set it before alerts are dispatched.
+    void setAlertHandler(std::function<void(const Alert&)> handler) { alertHandler = std::move(handler); }
+    
+    // Blocks until every dispatched alert's handlers have run
+    void waitForHandlers() {
+        if (dispatcher) dispatcher->waitIdle();
+    }
+    
+    void processAllAlerts() {
+        pollEscalations();
+        while (!alertQueue.empty()) {
+            processNextAlert();
+        }
+    }
+    
+    long getTotalAlertsProcessed() const { return totalAlertsProcessed; }
+    long getFalseAlarmsFiltered() const { return falseAlarmsFiltered; }
+    void recordFalseAlarm() { falseAlarmsFiltered++; }
+    bool hasAlerts() const { return !alertQueue.empty(); }
+    long getTotalEscalations() const { return totalEscalations; }
+    long getExpiredUnacknowledged() const { return expiredUnacknowledged; }
+    size_t getUnacknowledgedCount() const { return outstanding.size(); }
+    
+    // Number of times an unacknowledged alert is re-raised before it expires
+    void setMaxEscalations(int limit) { maxEscalations = limit; }
+    
+    // Response budget per priority; an alert still unacknowledged when its
+    // budget runs out is escalated
+    static MonitorClock::duration responseBudget(Priority priority) {
+        switch (priority) {
+            case Priority::CRITICAL: return std::chrono::seconds(2);
+            case Priority::HIGH: return std::chrono::seconds(30);
+            case Priority::MEDIUM: return std::chrono::seconds(300);
+            case Priority::LOW: return std::chrono::seconds(3600);
+            default: return std::chrono::seconds(3600);
+        }
+    }
+    
+    // One CSV line per dispatched alert: ms since 'epoch', patient, vital,
+    // kind (0 reading, 1 trend, 2 NEWS2 score), priority, escalation level,
+    // occurrences, message. Lines reach the
+    // stream on the background lane; the previous log, if any, is complete
+    // when this returns.
+    void setAlertLog(std::ostream* log, MonitorClock::time_point epoch) {
+        closeAlertLog();
+        if (log) {
+            alertLog = std::make_shared<BackgroundSink>(log, [this](std::function<void()> task) {
+                runInBackground(std::move(task));
+            });
+        }
+        alertLogEpoch = epoch;
+    }
+    
+    // Quiet mode keeps the bookkeeping but skips console output, so
+    // capacity runs are not bound by terminal I/O
+    void setVerbose(bool enabled) { verbose = enabled; }
+    bool isVerbose() const { return verbose; }
+    
+private:
+    // Every alert stays in the outstanding table until it is acknowledged or
+    // its patient is released; once its escalations run out it is flagged
+    // expired and no longer re-armed
+    void armEscalation(const std::shared_ptr<Alert>& alert) {
+        if (alert->acknowledged) return;
+        auto deadline = alert->createdAt + responseBudget(alert->priority);
+        TimingWheel::Handle timer;
+        {
+            std::lock_guard<std::mutex> lock(wheelMutex);
+            timer = escalationWheel.schedule(deadline, alert->alertId);
+        }
+        outstanding.insert(alert, timer);
+    }
+    
+    // Re-raise one priority level (CRITICAL re-notifies at CRITICAL),
+    // keeping the alert id so a single acknowledgement ends the chain.
+    // Runs inside pollEscalations with wheelMutex held.
+    void escalate(std::uint64_t alertId) {
+        std::shared_ptr<Alert> current = outstanding.find(alertId);
+        if (!current) return;
+        if (current->acknowledged) return;
+        if (current->escalationLevel >= maxEscalations) {
+            if (outstanding.markExpired(alertId)) expiredUnacknowledged++;
+            return;
+        }
+        
+        Priority raised = (current->priority == Priority::CRITICAL)
+            ? Priority::CRITICAL
+            : static_cast<Priority>(static_cast<int>(current->priority) - 1);
+        auto escalated = std::make_shared<Alert>(current->patientId, raised, current->message, current->relatedVital, current->kind);
+        escalated->alertId = current->alertId;
+        escalated->escalationLevel = current->escalationLevel + 1;
+        escalated->occurrenceCount = current->occurrenceCount;
+        escalated->lastSeen = current->lastSeen;
+        escalated->worstValue = current->worstValue;
+        
+        auto timer = escalationWheel.schedule(escalated->createdAt + responseBudget(raised), alertId);
+        if (!outstanding.replace(alertId, escalated, timer)) {
+            // Acknowledged between lookup and replace
+            escalationWheel.cancel(timer);
+            return;
+        }
+        alertQueue.push(escalated);
+        totalEscalations++;
+    }
+    
+    void handleAlert(std::shared_ptr<Alert> alert) {
+        auto now = MonitorClock::now();
+        auto responseTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+            now - alert->createdAt).count();
+            
+        // Check response time requirements
+        bool withinTimeRequirement = checkResponseTimeRequirement(alert->priority, responseTime);
+        if (verbose) {
+            std::lock_guard<std::mutex> lock(outputMutex);
+            printAlert(alert, responseTime, withinTimeRequirement);
+        }
+        if (alertHandler) {
+            alertHandler(*alert);
+        }
+    }
+    
+    // Formatted in dequeue order on the processing thread, so the log stays
+    // deterministic when handlers run in parallel
+    void logDispatch(const Alert& alert) {
+        if (!alertLog) return;
+        alertLogBuffer += std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(
+            alert.createdAt - alertLogEpoch).count());
+        alertLogBuffer += ',' + std::to_string(alert.patientId) + ',' + std::to_string(static_cast<int>(alert.relatedVital))
+                        + ',' + std::to_string(static_cast<int>(alert.kind))
+                        + ',' + std::to_string(static_cast<int>(alert.priority)) + ',' + std::to_string(alert.escalationLevel)
+                        + ',' + std::to_string(alert.occurrenceCount) + ',' + alert.message + '\n';
+        if (alertLogBuffer.size() >= ALERT_LOG_CHUNK) {
+            alertLog->write(std::move(alertLogBuffer));
+            alertLogBuffer.clear();
+        }
+    }
+    
+    void closeAlertLog() {
+        if (!alertLog) return;
+        alertLog->close(alertLogBuffer);
+        alertLogBuffer.clear();
+        alertLog.reset();
+    }
+    
+    void printAlert(const std::shared_ptr<Alert>& alert, long long responseTime, bool withinTimeRequirement) {
+        // Log the alert with response time
+        std::cout << "[" << getCurrentTimeString() << "] "
+                  << "[" << priorityToString(alert->priority) << "] "
+                  << "Patient " << alert->patientId << " #" << alert->alertId << ": " << alert->message 
+                  << " (Response: " << responseTime << "ms)" 
+                  << (alert->escalationLevel > 0 ? " [escalation " + std::to_string(alert->escalationLevel) + "]" : "")
+                  << (withinTimeRequirement ? " ✓" : " ⚠") << std::endl;
+        
+        // Simulate alert handling based on priority
+        switch (alert->priority) {
+            case Priority::CRITICAL:
+                handleCriticalAlert(alert);
+                break;
+            case Priority::HIGH:
+                handleHighAlert(alert);
+                break;
+            case Priority::MEDIUM:
+                handleMediumAlert(alert);
+                break;
+            case Priority::LOW:
+                handleLowAlert(alert);
+                break;
+        }
+    }
+    
+    bool checkResponseTimeRequirement(Priority priority, long responseTimeMs) {
+        return responseTimeMs <= std::chrono::duration_cast<std::chrono::milliseconds>(
+            responseBudget(priority)).count();
+    }
+    
+    void handleCriticalAlert(std::shared_ptr<Alert> alert) {
+        std::cout << "    >>> CRITICAL ALERT: Immediate medical attention required!" << std::endl;
+    }
+    
+    void handleHighAlert(std::shared_ptr<Alert> alert) {
+        std::cout << "    >>> HIGH PRIORITY: Nurse response needed within 30 seconds" << std::endl;
+    }
+    
+    void handleMediumAlert(std::shared_ptr<Alert> alert) {
+        std::cout << "    >>> MEDIUM: Check on patient within 5 minutes" << std::endl;
+    }
+    
+    void handleLowAlert(std::shared_ptr<Alert> alert) {
+        std::cout << "    >>> LOW: Routine check during next rounds" << std::endl;
+    }
+    
+    std::string priorityToString(Priority p) {
+        switch (p) {
+            case Priority::CRITICAL: return "CRITICAL";
+            case Priority::HIGH: return "HIGH    ";
+            case Priority::MEDIUM: return "MEDIUM  ";
+            case Priority::LOW: return "LOW     ";
+            default: return "UNKNOWN ";
+        }
+    }
+    
+    std::string getCurrentTimeString() {
+        auto now = MonitorClock::toWallClock(MonitorClock::now());
+        auto time_t = std::chrono::system_clock::to_time_t(now);
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            now.time_since_epoch()) % 1000;
+        
+        std::stringstream ss;
+        ss << std::put_time(std::localtime(&time_t), "%H:%M:%S");
+        ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
+        return ss.str();
+    }
+};
+
+#ifdef ASYNC_NOTIFICATIONS
+class NotificationLoop;
+
+// Coroutine task of notification I/O, completing with a delivered flag
+// Starts lazily: awaiting a task runs it and resumes the awaiter when it
+// finishes, while NotificationLoop::spawn runs it detached.
+class NotifyTask {
+public:
+    struct promise_type;
+    using Handle = std::coroutine_handle<promise_type>;
+    
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(Handle finished) noexcept;
+        void await_resume() const noexcept {}
+    };
+    
+    struct promise_type {
+        bool delivered = false;
+        std::coroutine_handle<> continuation;
+        NotificationLoop* owner = nullptr;   // set while running detached
+        
+        NotifyTask get_return_object() { return NotifyTask(Handle::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void return_value(bool value) { delivered = value; }
+        void unhandled_exception() { delivered = false; }
+    };
+    
+    NotifyTask(NotifyTask&& other) noexcept : coro(std::exchange(other.coro, {})) {}
+    NotifyTask& operator=(NotifyTask&& other) noexcept {
+        if (this != &other) {
+            if (coro) coro.destroy();
+            coro = std::exchange(other.coro, {});
+        }
+        return *this;
+    }
+    ~NotifyTask() {
+        if (coro) coro.destroy();
+    }
+    
+    bool await_ready() const noexcept { return !coro || coro.done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+        coro.promise().continuation = awaiter;
+        return coro;
+    }
+    bool await_resume() const noexcept { return coro && coro.promise().delivered; }
+    
+    Handle release() { return std::exchange(coro, {}); }
+    
+private:
+    Handle coro;
+    
+    explicit NotifyTask(Handle handle) : coro(handle) {}
+};
+
+// Single-threaded epoll executor for notification coroutines
+// Coroutines suspend on fd readiness (one-shot registrations keyed by the
+// coroutine frame) or on the ready queue, so one thread can hold thousands
+// of notifications in flight. post() is the only thread-safe entry point;
+// it wakes the loop through an eventfd.
+class NotificationLoop {
+public:
+    NotificationLoop()
+        : epollFd(::epoll_create1(EPOLL_CLOEXEC)), wakeFd(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+          inFlight(0), peakInFlight(0), stopping(false) {
+        if (epollFd < 0 || wakeFd < 0) {
+            throw std::runtime_error("NotificationLoop: epoll or eventfd unavailable");
+        }
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.ptr = nullptr;   // the wake fd
+        ::epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+    }
+    
+    // Frames still suspended are destroyed without being resumed
+    ~NotificationLoop() {
+        for (auto& entry : detached) entry.second.destroy();
+        ::close(wakeFd);
+        ::close(epollFd);
+    }
+    
+    NotificationLoop(const NotificationLoop&) = delete;
+    NotificationLoop& operator=(const NotificationLoop&) = delete;
+    
+    // Runs 'task' detached; background tasks (connection readers, accept
+    // loops) do not count as in flight. Loop thread only.
+    void spawn(NotifyTask task, bool background = false) {
+        NotifyTask::Handle handle = task.release();
+        if (!handle) return;
+        handle.promise().owner = this;
+        detached.emplace(handle.address(), handle);
+        if (!background) {
+            counted.insert(handle.address());
+            peakInFlight = std::max(peakInFlight, ++inFlight);
+        }
+        ready.push_back(handle);
+    }
+    
+    // Resumes 'waiter' on the next iteration. Loop thread only.
+    void schedule(std::coroutine_handle<> waiter) { ready.push_back(waiter); }
+    
+    // Thread-safe: runs 'work' on the loop thread
+    void post(std::function<void()> work) {
+        {
+            std::lock_guard<std::mutex> lock(postMutex);
+            posted.push_back(std::move(work));
+        }
+        wake();
+    }
+    
+    // Runs on the calling thread until stop()
+    void run() {
+        while (!stopping.load(std::memory_order_acquire)) {
+            runOnce(100);
+        }
+    }
+    
+    // Thread-safe; run() returns after its current iteration
+    void stop() {
+        stopping.store(true, std::memory_order_release);
+        wake();
+    }
+    
+    // Drives the loop on the calling thread until no counted task is in
+    // flight; false if 'timeout' ran out first
+    bool runUntilIdle(std::chrono::milliseconds timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (inFlight > 0 || !ready.empty()) {
+            if (std::chrono::steady_clock::now() >= deadline) return false;
+            runOnce(10);
+        }
+        return true;
+    }
+    
+    size_t getInFlight() const { return inFlight; }
+    size_t getPeakInFlight() const { return peakInFlight; }
+    
+    // co_await loop.readable(fd) / writable(fd): resumes once the fd is ready
+    struct FdAwaiter {
+        NotificationLoop& loop;
+        int fd;
+        std::uint32_t events;
+        
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> waiter) {
+            epoll_event event{};
+            event.events = events | EPOLLONESHOT;
+            event.data.ptr = waiter.address();
+            if (::epoll_ctl(loop.epollFd, EPOLL_CTL_MOD, fd, &event) == 0) return true;
+            // Not registered yet; on failure resume at once and let the retry see the error
+            return errno == ENOENT && ::epoll_ctl(loop.epollFd, EPOLL_CTL_ADD, fd, &event) == 0;
+        }
+        void await_resume() const noexcept {}
+    };
+    
+    FdAwaiter readable(int fd) { return FdAwaiter{*this, fd, EPOLLIN | EPOLLRDHUP}; }
+    FdAwaiter writable(int fd) { return FdAwaiter{*this, fd, EPOLLOUT}; }
+    
+private:
+    friend struct NotifyTask::FinalAwaiter;
+    
+    int epollFd;
+    int wakeFd;
+    std::deque<std::coroutine_handle<>> ready;
+    std::unordered_map<void*, NotifyTask::Handle> detached;   // owned frames
+    std::unordered_set<void*> counted;                        // ... of which in flight
+    size_t inFlight;
+    size_t peakInFlight;
+    std::vector<NotifyTask::Handle> finished;
+    std::mutex postMutex;
+    std::vector<std::function<void()>> posted;
+    std::atomic<bool> stopping;
+    
+    void wake() {
+        std::uint64_t one = 1;
+        if (::write(wakeFd, &one, sizeof(one)) < 0) {
+            // Counter saturated: the loop is already due to wake
+        }
+    }
+    
+    void runOnce(int timeoutMs) {
+        while (!ready.empty()) {
+            std::coroutine_handle<> next = ready.front();
+            ready.pop_front();
+            next.resume();
+            reap();
+        }
+        
+        epoll_event events[256];
+        int count = ::epoll_wait(epollFd, events, 256, timeoutMs);
+        for (int i = 0; i < count; ++i) {
+            if (events[i].data.ptr == nullptr) {
+                std::uint64_t value;
+                while (::read(wakeFd, &value, sizeof(value)) > 0) {
+                }
+                std::vector<std::function<void()>> work;
+                {
+                    std::lock_guard<std::mutex> lock(postMutex);
+                    work.swap(posted);
+                }
+                for (auto& item : work) item();
+            } else {
+                ready.push_back(std::coroutine_handle<>::from_address(events[i].data.ptr));
+            }
+        }
+    }
+    
+    void reap() {
+        for (NotifyTask::Handle handle : finished) {
+            detached.erase(handle.address());
+            if (counted.erase(handle.address())) inFlight--;
+            handle.destroy();
+        }
+        finished.clear();
+    }
+};
+
+inline std::coroutine_handle<> NotifyTask::FinalAwaiter::await_suspend(Handle finished) noexcept {
+    promise_type& promise = finished.promise();
+    if (promise.continuation) return promise.continuation;
+    if (promise.owner) promise.owner->finished.push_back(finished);
+    return std::noop_coroutine();
+}
+
+// Client of a paging gateway on a UNIX stream socket
+// Requests are pipelined on one connection as
+//   PAGE <request> <alert id> <priority> <patient> <message>\n
+// and answered with "ACK <request>\n" in any order. Each page() awaits its
+// own ack, so thousands can be in flight on one socket and one thread. The
+// reader and writer coroutines use separate descriptors (a dup) so each has
+// its own epoll registration. A page not acknowledged within the ack
+// timeout fails; one timerfd on the loop tracks the earliest deadline. A
+// dropped connection fails the pages in flight on it and is re-established
+// with exponential backoff; pages issued meanwhile wait for it, up to their
+// deadline. Used on its loop's thread only, and must not be destroyed while
+// that loop is running.
+class PagerClient {
+public:
+    static constexpr std::chrono::milliseconds DEFAULT_ACK_TIMEOUT{5000};
+    static constexpr std::chrono::milliseconds MIN_BACKOFF{50};
+    static constexpr std::chrono::milliseconds MAX_BACKOFF{5000};
+    
+    explicit PagerClient(NotificationLoop& eventLoop, std::chrono::milliseconds ackDeadline = DEFAULT_ACK_TIMEOUT)
+        : loop(eventLoop), readFd(-1), writeFd(-1), timerFd(-1), outOffset(0), nextRequest(1), writing(false),
+          ackTimeout(ackDeadline), backoff(MIN_BACKOFF), reconnectAt(Clock::time_point::max()),
+          timedOut(0), reconnects(0) {}
+    
+    // The loop no longer runs, so the reader and writer cannot close their
+    // descriptors themselves
+    ~PagerClient() {
+        if (readFd >= 0) ::close(readFd);
+        if (writeFd >= 0) ::close(writeFd);
+        failPending();
+        if (timerFd >= 0) ::close(timerFd);
+    }
+    
+    PagerClient(const PagerClient&) = delete;
+    PagerClient& operator=(const PagerClient&) = delete;
+    
+    // Connecting to a local socket does not wait on the network, so it is
+    // done in place. On failure the client keeps retrying with backoff.
+    bool connect(const std::string& socketPath) {
+        closeConnection();
+        failPending();
+        path = socketPath;
+        backoff = MIN_BACKOFF;
+        if (openConnection()) return true;
+        scheduleReconnect();
+        return false;
+    }
+    
+    bool isConnected() const { return readFd >= 0; }
+    size_t getOutstanding() const { return pending.size(); }
+    long getTimedOut() const { return timedOut; }
+    long getReconnects() const { return reconnects; }
+    
+    NotifyTask page(const Alert& alert) {
+        return page(alert.alertId, alert.priority, alert.patientId, alert.message);
+    }
+    
+    // Completes true once the gateway acknowledged the page, false on a
+    // dropped connection or when the ack timeout passes first
+    NotifyTask page(std::uint64_t alertId, Priority priority, int patientId, std::string message) {
+        if (path.empty() || !startTimer()) co_return false;
+        std::replace(message.begin(), message.end(), '\n', ' ');
+        std::uint64_t request = nextRequest++;
+        outBuffer += "PAGE " + std::to_string(request) + ' ' + std::to_string(alertId) + ' ' +
+                     std::to_string(static_cast<int>(priority)) + ' ' + std::to_string(patientId) + ' ' +
+                     message + '\n';
+        if (isConnected() && !writing) {
+            writing = true;
+            loop.spawn(writer());
+        }
+        
+        Pending entry;
+        pending.emplace(request, &entry);
+        deadlines.emplace(Clock::now() + ackTimeout, request);
+        rearmTimer();
+        co_await AckAwaiter{entry};
+        co_return entry.acked;
+    }
+    
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    struct Pending {
+        std::coroutine_handle<> waiter;
+        bool acked = false;
+    };
+    
+    struct AckAwaiter {
+        Pending& entry;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> waiter) noexcept { entry.waiter = waiter; }
+        void await_resume() const noexcept {}
+    };
+    
+    NotificationLoop& loop;
+    std::string path;
+    int readFd;
+    int writeFd;
+    int timerFd;
+    std::string outBuffer;
+    size_t outOffset;
+    std::uint64_t nextRequest;
+    bool writing;
+    std::unordered_map<std::uint64_t, Pending*> pending;   // entries live in page() frames
+    std::multimap<Clock::time_point, std::uint64_t> deadlines;   // may name requests already answered
+    std::chrono::milliseconds ackTimeout;
+    std::chrono::milliseconds backoff;
+    Clock::time_point reconnectAt;
+    long timedOut;
+    long reconnects;
+    
+    bool openConnection() {
+        int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) return false;
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            ::close(fd);
+            return false;
+        }
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+        int dup = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+        if (dup < 0) {
+            ::close(fd);
+            return false;
+        }
+        readFd = fd;
+        writeFd = dup;
+        backoff = MIN_BACKOFF;
+        reconnectAt = Clock::time_point::max();
+        loop.spawn(reader(), true);
+        if (!outBuffer.empty() && !writing) {
+            writing = true;
+            loop.spawn(writer());
+        }
+        return true;
+    }
+    
+    // Shutting the socket down wakes a reader or writer suspended on it;
+    // each closes its own descriptor once it sees it is no longer current
+    void closeConnection() {
+        if (readFd < 0) return;
+        ::shutdown(readFd, SHUT_RDWR);
+        readFd = -1;
+        if (!writing) ::close(writeFd);
+        writeFd = -1;
+        outBuffer.clear();
+        outOffset = 0;
+    }
+    
+    void connectionLost() {
+        closeConnection();
+        failPending();
+        scheduleReconnect();
+    }
+    
+    void failPending() {
+        for (auto& entry : pending) {
+            entry.second->acked = false;
+            if (entry.second->waiter) loop.schedule(entry.second->waiter);
+        }
+        pending.clear();
+        deadlines.clear();
+    }
+    
+    void scheduleReconnect() {
+        if (path.empty() || !startTimer()) return;
+        reconnectAt = Clock::now() + backoff;
+        backoff = std::min(backoff * 2, MAX_BACKOFF);
+        rearmTimer();
+    }
+    
+    // Creates the timerfd and its watcher on first use
+    bool startTimer() {
+        if (timerFd >= 0) return true;
+        timerFd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (timerFd < 0) return false;
+        loop.spawn(timerWatcher(), true);
+        return true;
+    }
+    
+    // Arms the timer for the earliest ack deadline or reconnect attempt
+    void rearmTimer() {
+        Clock::time_point due = reconnectAt;
+        if (!deadlines.empty()) due = std::min(due, deadlines.begin()->first);
+        itimerspec spec{};
+        if (due != Clock::time_point::max()) {
+            auto wait = std::max(std::chrono::nanoseconds(1), std::chrono::nanoseconds(due - Clock::now()));
+            spec.it_value.tv_sec = static_cast<time_t>(wait.count() / 1000000000);
+            spec.it_value.tv_nsec = static_cast<long>(wait.count() % 1000000000);
+        }
+        ::timerfd_settime(timerFd, 0, &spec, nullptr);
+    }
+    
+    NotifyTask timerWatcher() {
+        while (true) {
+            std::uint64_t expirations;
+            if (::read(timerFd, &expirations, sizeof(expirations)) < 0) {
+                if (errno != EAGAIN && errno != EINTR) co_return false;
+                co_await loop.readable(timerFd);
+                continue;
+            }
+            auto now = Clock::now();
+            while (!deadlines.empty() && deadlines.begin()->first <= now) {
+                auto it = pending.find(deadlines.begin()->second);
+                deadlines.erase(deadlines.begin());
+                if (it == pending.end()) continue;   // answered in time
+                it->second->acked = false;
+                loop.schedule(it->second->waiter);
+                pending.erase(it);
+                timedOut++;
+            }
+            if (reconnectAt <= now) {
+                reconnectAt = Clock::time_point::max();
+                if (openConnection()) {
+                    reconnects++;
+                } else {
+                    scheduleReconnect();
+                }
+            }
+            rearmTimer();
+        }
+    }
+    
+    NotifyTask writer() {
+        int fd = writeFd;
+        while (fd == writeFd && outOffset < outBuffer.size()) {
+            ssize_t sent = ::send(fd, outBuffer.data() + outOffset, outBuffer.size() - outOffset, MSG_NOSIGNAL);
+            if (sent > 0) {
+                outOffset += static_cast<size_t>(sent);
+            } else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                co_await loop.writable(fd);
+            } else if (!(sent < 0 && errno == EINTR)) {
+                if (fd == writeFd) connectionLost();
+            }
+        }
+        writing = false;
+        if (fd != writeFd) {
+            // The connection was closed meanwhile; a replacement gets its own writer
+            ::close(fd);
+            if (isConnected() && !outBuffer.empty()) {
+                writing = true;
+                loop.spawn(writer());
+            }
+            co_return false;
+        }
+        outBuffer.clear();
+        outOffset = 0;
+        co_return true;
+    }
+    
+    NotifyTask reader() {
+        std::string input;
+        char buffer[4096];
+        int fd = readFd;
+        while (fd == readFd) {
+            ssize_t received = ::recv(fd, buffer, sizeof(buffer), 0);
+            if (received > 0) {
+                input.append(buffer, static_cast<size_t>(received));
+                size_t start = 0;
+                for (size_t end; (end = input.find('\n', start)) != std::string::npos; start = end + 1) {
+                    if (input.compare(start, 4, "ACK ") != 0) continue;
+                    auto it = pending.find(std::strtoull(input.c_str() + start + 4, nullptr, 10));
+                    if (it == pending.end()) continue;
+                    it->second->acked = true;
+                    loop.schedule(it->second->waiter);
+                    pending.erase(it);
+                }
+                input.erase(0, start);
+            } else if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                co_await loop.readable(fd);
+            } else if (!(received < 0 && errno == EINTR)) {
+                if (fd == readFd) connectionLost();   // gateway closed the connection
+                break;
+            }
+        }
+        ::close(fd);
+        co_return false;
+    }
+};
+
+// Stand-in paging gateway for tests and demos: a UNIX socket server on its
+// own NotificationLoop thread that acknowledges every PAGE line. With
+// holdUntil > 0 it withholds acks until that many pages have arrived, so a
+// client is forced to keep them all in flight at once.
+class PagerMock {
+public:
+    PagerMock(const std::string& socketPath, size_t holdUntil = 0)
+        : path(socketPath), listenFd(-1), hold(holdUntil), received(0) {
+        ::unlink(path.c_str());
+        listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+        if (listenFd < 0 || ::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+            ::listen(listenFd, 64) < 0) {
+            if (listenFd >= 0) ::close(listenFd);
+            throw std::runtime_error("PagerMock: cannot listen on " + path);
+        }
+        loop.post([this]() { loop.spawn(acceptLoop(), true); });
+        thread = std::thread([this]() { loop.run(); });
+    }
+    
+    ~PagerMock() {
+        loop.stop();
+        thread.join();
+        for (int fd : sessions) ::close(fd);
+        ::close(listenFd);
+        ::unlink(path.c_str());
+    }
+    
+    size_t getPagesReceived() const { return received.load(std::memory_order_relaxed); }
+    
+private:
+    std::string path;
+    int listenFd;
+    size_t hold;
+    std::atomic<size_t> received;
+    std::vector<int> sessions;
+    std::vector<std::pair<int, std::string>> held;   // (session fd, ack line)
+    NotificationLoop loop;
+    std::thread thread;
+    
+    NotifyTask acceptLoop() {
+        while (true) {
+            int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd >= 0) {
+                sessions.push_back(fd);
+                loop.spawn(session(fd), true);
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                co_await loop.readable(listenFd);
+            } else {
+                co_return false;
+            }
+        }
+    }
+    
+    NotifyTask session(int fd) {
+        std::string input;
+        char buffer[4096];
+        while (true) {
+            ssize_t count = ::recv(fd, buffer, sizeof(buffer), 0);
+            if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+                co_await loop.readable(fd);
+                continue;
+            }
+            if (count <= 0) co_return true;   // client went away
+            
+            input.append(buffer, static_cast<size_t>(count));
+            std::string acks;
+            size_t start = 0;
+            for (size_t end; (end = input.find('\n', start)) != std::string::npos; start = end + 1) {
+                if (input.compare(start, 5, "PAGE ") != 0) continue;
+                size_t requestEnd = input.find(' ', start + 5);
+                acks += "ACK " + input.substr(start + 5, requestEnd - start - 5) + '\n';
+                received.fetch_add(1, std::memory_order_relaxed);
+            }
+            input.erase(0, start);
+            
+            if (received.load(std::memory_order_relaxed) < hold) {
+                held.emplace_back(fd, std::move(acks));
+                continue;
+            }
+            for (auto& entry : held) {
+                if (!co_await sendAll(entry.first, entry.second)) co_return false;
+            }
+            held.clear();
+            if (!co_await sendAll(fd, acks)) co_return false;
+        }
+    }
+    
+    NotifyTask sendAll(int fd, std::string data) {
+        size_t offset = 0;
+        while (offset < data.size()) {
+            ssize_t sent = ::send(fd, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+            if (sent > 0) {
+                offset += static_cast<size_t>(sent);
+            } else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                co_await loop.writable(fd);
+            } else if (!(sent < 0 && errno == EINTR)) {
+                co_return false;
+            }
+        }
+        co_return true;
+    }
+};
+
+// Asynchronous notification fan-out for alert handlers
+// Owns an event-loop thread and a pager connection. notify() is thread-safe
+// and returns at once; the page is written and acknowledged on the loop, so
+// a handler thread never blocks on notification I/O. Every page completes
+// within the ack timeout, delivered or failed. Plug it in with
+// AlertProcessor::setAlertHandler.
+class AsyncNotifier {
+public:
+    explicit AsyncNotifier(const std::string& pagerSocket,
+                           std::chrono::milliseconds ackDeadline = PagerClient::DEFAULT_ACK_TIMEOUT)
+        : pager(loop, ackDeadline), ackTimeout(ackDeadline), submitted(0), delivered(0), failed(0) {
+        std::mutex connectMutex;
+        std::condition_variable connected;
+        bool done = false;
+        loop.post([&]() {
+            pager.connect(pagerSocket);
+            std::lock_guard<std::mutex> lock(connectMutex);
+            done = true;
+            connected.notify_one();
+        });
+        thread = std::thread([this]() { loop.run(); });
+        std::unique_lock<std::mutex> lock(connectMutex);
+        connected.wait(lock, [&done]() { return done; });
+    }
+    
+    // Gives pages in flight until their deadline, then stops the loop
+    ~AsyncNotifier() {
+        waitIdle(2 * ackTimeout);
+        loop.stop();
+        thread.join();
+    }
+    
+    void notify(const Alert& alert) {
+        submitted.fetch_add(1, std::memory_order_relaxed);
+        loop.post([this, alertId = alert.alertId, priority = alert.priority, patientId = alert.patientId,
+                   message = alert.message]() {
+            loop.spawn(deliver(alertId, priority, patientId, message));
+        });
+    }
+    
+    // Blocks until every notification so far was acknowledged or failed;
+    // false if 'timeout' ran out first
+    bool waitIdle(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(idleMutex);
+        return idle.wait_for(lock, timeout, [this]() { return completed() == submitted.load(std::memory_order_acquire); });
+    }
+    
+    long getDelivered() const { return delivered.load(std::memory_order_relaxed); }
+    long getFailed() const { return failed.load(std::memory_order_relaxed); }
+    size_t getPeakInFlight() const { return loop.getPeakInFlight(); }
+    
+private:
+    NotificationLoop loop;
+    PagerClient pager;   // after the loop, so it goes first and the loop never resumes it
+    std::chrono::milliseconds ackTimeout;
+    std::thread thread;
+    std::atomic<long> submitted;
+    std::atomic<long> delivered;
+    std::atomic<long> failed;
+    std::mutex idleMutex;
+    std::condition_variable idle;
+    
+    long completed() const {
+        return delivered.load(std::memory_order_acquire) + failed.load(std::memory_order_acquire);
+    }
+    
+    NotifyTask deliver(std::uint64_t alertId, Priority priority, int patientId, std::string message) {
+        bool ok = co_await pager.page(alertId, priority, patientId, std::move(message));
+        (ok ? delivered : failed).fetch_add(1, std::memory_order_acq_rel);
+        if (completed() == submitted.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(idleMutex);
+            idle.notify_all();
+        }
+        co_return ok;
+    }
+};
+#endif
+
+// Calendar queue of device sample events on virtual time
+// Events hash into fixed-width time buckets (time / width % bucketCount);
+// dequeue drains one bucket window at a time, so scheduling and popping are
+// O(1) amortized when the bucket width matches the event density.
+class SampleEventQueue {
+public:
+    struct Event {
+        MonitorClock::time_point time;
+        int deviceIndex;
+    };
+    
+    SampleEventQueue(MonitorClock::duration width = std::chrono::seconds(1), size_t bucketCount = 4096)
+        : buckets(bucketCount), bucketWidth(width), currentBucket(0),
+          windowStart(MonitorClock::time_point()), eventCount(0) {}
+    
+    void schedule(MonitorClock::time_point time, int deviceIndex) {
+        if (eventCount == 0 || time < windowStart) {
+            // Re-anchor the calendar so the current window contains 'time'
+            windowStart = bucketFloor(time);
+            currentBucket = bucketIndex(windowStart);
+        }
+        buckets[bucketIndex(time)].push_back({time, deviceIndex});
+        eventCount++;
+    }
+    
+    // Moves every event of the earliest non-empty window into 'out',
+    // ordered by time. Returns false when the queue is empty.
+    bool popNextWindow(std::vector<Event>& out) {
+        out.clear();
+        if (eventCount == 0) return false;
+        
+        size_t emptyWindows = 0;
+        while (true) {
+            auto windowEnd = windowStart + bucketWidth;
+            auto& bucket = buckets[currentBucket];
+            
+            // Events from later calendar "years" stay in the bucket
+            auto split = std::partition(bucket.begin(), bucket.end(),
+                [windowEnd](const Event& e) { return e.time >= windowEnd; });
+            if (split != bucket.end()) {
+                out.assign(split, bucket.end());
+                bucket.erase(split, bucket.end());
+                eventCount -= out.size();
+                std::sort(out.begin(), out.end(), [](const Event& a, const Event& b) {
+                    return a.time < b.time || (a.time == b.time && a.deviceIndex < b.deviceIndex);
+                });
+                return true;
+            }
+            
+            advanceWindow();
+            if (++emptyWindows >= buckets.size()) {
+                // A whole year was empty: jump straight to the earliest event
+                windowStart = bucketFloor(findEarliest());
+                currentBucket = bucketIndex(windowStart);
+                emptyWindows = 0;
+            }
+        }
+    }
+    
+    size_t size() const { return eventCount; }
+    bool empty() const { return eventCount == 0; }
+    
+private:
+    std::vector<std::vector<Event>> buckets;
+    MonitorClock::duration bucketWidth;
+    size_t currentBucket;
+    MonitorClock::time_point windowStart;
+    size_t eventCount;
+    
+    MonitorClock::time_point bucketFloor(MonitorClock::time_point time) const {
+        auto ticks = time.time_since_epoch() / bucketWidth;
+        return MonitorClock::time_point(ticks * bucketWidth);
+    }
+    
+    size_t bucketIndex(MonitorClock::time_point time) const {
+        auto ticks = time.time_since_epoch() / bucketWidth;
+        return static_cast<size_t>(ticks) % buckets.size();
+    }
+    
+    void advanceWindow() {
+        windowStart += bucketWidth;
+        currentBucket = (currentBucket + 1) % buckets.size();
+    }
+    
+    MonitorClock::time_point findEarliest() const {
+        MonitorClock::time_point earliest = MonitorClock::time_point::max();
+        for (const auto& bucket : buckets) {
+            for (const auto& e : bucket) {
+                earliest = std::min(earliest, e.time);
+            }
+        }
+        return earliest;
+    }
+};
+
+// Alert coalescing stage
+// Folds repeats of the same condition, keyed by (patient, vital, priority,
+// kind), into the alert already open for it. Compact open-addressing table
+// (linear probing, backward-shift deletion) of 32-byte entries; an entry
+// expires once its condition has been quiet for the coalescing window.
+class AlertCoalescer {
+public:
+    using Kind = AlertKind;
+    
+    explicit AlertCoalescer(MonitorClock::duration quietWindow = std::chrono::seconds(60))
+        : window(quietWindow), table(INITIAL_CAPACITY), liveCount(0) {}
+    
+    static std::uint64_t makeKey(int patientId, VitalSign vital, Priority priority, Kind kind) {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(patientId)) << 32) |
+               (static_cast<std::uint64_t>(vital) << 16) |
+               (static_cast<std::uint64_t>(priority) << 8) |
+               static_cast<std::uint64_t>(kind);
+    }
+    
+    // Key of a patient-level condition such as the NEWS2 score; its vital
+    // field holds VITAL_SIGN_COUNT, so it never collides with a vital's key
+    static std::uint64_t makeKey(int patientId, Priority priority, Kind kind) {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(patientId)) << 32) |
+               (static_cast<std::uint64_t>(VITAL_SIGN_COUNT) << 16) |
+               (static_cast<std::uint64_t>(priority) << 8) |
+               static_cast<std::uint64_t>(kind);
+    }
+    
+    // Alert id still coalescing for 'key' at time 'now', or 0
+    std::uint64_t findOpen(std::uint64_t key, MonitorClock::time_point now) {
+        size_t slot = probe(key);
+        Entry& entry = table[slot];
+        if (entry.key != key) return 0;
+        if (isExpired(entry, now)) {
+            eraseSlot(slot);
+            return 0;
+        }
+        return entry.alertId;
+    }
+    
+    // Records one more occurrence; returns true if it is the new worst value
+    bool fold(std::uint64_t key, MonitorClock::time_point now, double deviation) {
+        Entry& entry = table[probe(key)];
+        entry.lastSeenNanos = now.time_since_epoch().count();
+        if (deviation > entry.worstDeviation) {
+            entry.worstDeviation = deviation;
+            return true;
+        }
+        return false;
+    }
+    
+    void open(std::uint64_t key, std::uint64_t alertId, MonitorClock::time_point now, double deviation) {
+        if ((liveCount + 1) * 2 > table.size()) {
+            rehash(now);
+        }
+        size_t slot = probe(key);
+        if (table[slot].key != key) liveCount++;
+        table[slot] = Entry{key, alertId, now.time_since_epoch().count(), deviation};
+    }
+    
+    // The open alert was acknowledged or dropped: stop folding into it
+    void close(std::uint64_t key) {
+        size_t slot = probe(key);
+        if (table[slot].key == key) eraseSlot(slot);
+    }
+    
+    size_t size() const { return liveCount; }
+    
+private:
+    static constexpr size_t INITIAL_CAPACITY = 1024;
+    static constexpr std::uint64_t EMPTY = 0; // patient ids are never 0 in keys
+    
+    struct Entry {
+        std::uint64_t key;
+        std::uint64_t alertId;
+        MonitorClock::rep lastSeenNanos;
+        double worstDeviation;
+    };
+    
+    MonitorClock::duration window;
+    std::vector<Entry> table;
+    size_t liveCount;
+    
+    static size_t hashKey(std::uint64_t key) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return static_cast<size_t>(key);
+    }
+    
+    // Slot holding 'key', or the empty slot where it would be inserted
+    size_t probe(std::uint64_t key) const {
+        size_t mask = table.size() - 1;
+        size_t slot = hashKey(key) & mask;
+        while (table[slot].key != EMPTY && table[slot].key != key) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+    
+    bool isExpired(const Entry& entry, MonitorClock::time_point now) const {
+        return now.time_since_epoch().count() - entry.lastSeenNanos > window.count();
+    }
+    
+    void eraseSlot(size_t slot) {
+        size_t mask = table.size() - 1;
+        table[slot].key = EMPTY;
+        liveCount--;
+        
+        // Backward-shift the rest of the cluster so probes never need tombstones
+        size_t next = (slot + 1) & mask;
+        while (table[next].key != EMPTY) {
+            size_t home = hashKey(table[next].key) & mask;
+            if (((next - home) & mask) >= ((next - slot) & mask)) {
+                table[slot] = table[next];
+                table[next].key = EMPTY;
+                slot = next;
+            }
+            next = (next + 1) & mask;
+        }
+    }
+    
+    // Drops expired entries, growing only if the live set still needs it
+    void rehash(MonitorClock::time_point now) {
+        std::vector<Entry> old;
+        old.swap(table);
+        
+        size_t live = 0;
+        for (const auto& entry : old) {
+            if (entry.key != EMPTY && !isExpired(entry, now)) live++;
+        }
+        size_t capacity = INITIAL_CAPACITY;
+        while (capacity < (live + 1) * 4) capacity *= 2;
+        
+        table.assign(capacity, Entry{EMPTY, 0, 0, 0.0});
+        liveCount = 0;
+        for (const auto& entry : old) {
+            if (entry.key != EMPTY && !isExpired(entry, now)) {
+                table[probe(entry.key)] = entry;
+                liveCount++;
+            }
+        }
+    }
+};
+
+// Binary trace of the reading stream a scheduler received
+// Layout: 32-byte header, then records of
+//   [u8 kind=READING][varint zigzag ts delta ns][varint zigzag patient][u8 vital][f64 value]
+//   [u8 kind=ADMISSION][varint zigzag patient][varint age]
+// Timestamps are delta-encoded against the previous reading, values are
+// stored bit-exact (little-endian hosts), so a typical reading costs ~12 bytes.
+// Records are encoded on the recording thread and written in chunks through
+// a BackgroundSink; the file is complete once the writer is destroyed.
+class ReadingTraceWriter {
+public:
+    explicit ReadingTraceWriter(const std::string& path, BackgroundSink::Runner runner = nullptr)
+        : out(path, std::ios::binary | std::ios::trunc),
+          sink(std::make_shared<BackgroundSink>(&out, std::move(runner))),
+          headerWritten(false), previousNanos(0), readingCount(0) {}
+    
+    ~ReadingTraceWriter() {
+        sink->close(buffer);
+    }
+    
+    bool isOpen() const { return out.is_open() && out.good(); }
+    
+    void writeAdmission(int patientId, int age) {
+        writeHeaderOnce(MonitorClock::now());
+        buffer.push_back(static_cast<char>(ADMISSION));
+        writeVarint(zigzag(patientId));
+        writeVarint(static_cast<std::uint64_t>(std::max(0, age)));
+        flushChunk();
+    }
+    
+    void writeReading(const VitalReading& reading) {
+        writeHeaderOnce(reading.timestamp);
+        MonitorClock::rep nanos = reading.timestamp.time_since_epoch().count();
+        buffer.push_back(static_cast<char>(READING));
+        writeVarint(zigzag(nanos - previousNanos));
+        writeVarint(zigzag(reading.patientId));
+        buffer.push_back(static_cast<char>(reading.type));
+        char bytes[sizeof(double)];
+        std::memcpy(bytes, &reading.value, sizeof(double));
+        buffer.append(bytes, sizeof(double));
+        previousNanos = nanos;
+        readingCount++;
+        flushChunk();
+    }
+    
+    long getReadingCount() const { return readingCount; }
+    
+    static constexpr char MAGIC[8] = {'H', 'P', 'M', 'T', 'R', 'C', '0', '1'};
+    static constexpr std::uint8_t READING = 0;
+    static constexpr std::uint8_t ADMISSION = 1;
+    
+private:
+    static constexpr size_t CHUNK_BYTES = 64 * 1024;
+    
+    std::ofstream out;
+    std::shared_ptr<BackgroundSink> sink;
+    std::string buffer;
+    bool headerWritten;
+    MonitorClock::rep previousNanos;
+    long readingCount;
+    
+    void flushChunk() {
+        if (buffer.size() < CHUNK_BYTES) return;
+        sink->write(std::move(buffer));
+        buffer.clear();
+    }
+    
+    // Header: magic, version, reserved, wall-clock anchor, first timestamp
+    void writeHeaderOnce(MonitorClock::time_point first) {
+        if (headerWritten) return;
+        headerWritten = true;
+        previousNanos = first.time_since_epoch().count();
+        std::int64_t wallNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            MonitorClock::toWallClock(first).time_since_epoch()).count();
+        std::uint32_t version = 1, reserved = 0;
+        buffer.append(MAGIC, sizeof(MAGIC));
+        buffer.append(reinterpret_cast<const char*>(&version), sizeof(version));
+        buffer.append(reinterpret_cast<const char*>(&reserved), sizeof(reserved));
+        buffer.append(reinterpret_cast<const char*>(&wallNanos), sizeof(wallNanos));
+        buffer.append(reinterpret_cast<const char*>(&previousNanos), sizeof(previousNanos));
+    }
+    
+    static std::uint64_t zigzag(std::int64_t v) {
+        return (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63);
+    }
+    
+    void writeVarint(std::uint64_t v) {
+        while (v >= 0x80) {
+            buffer.push_back(static_cast<char>((v & 0x7F) | 0x80));
+            v >>= 7;
+        }
+        buffer.push_back(static_cast<char>(v));
+    }
+};
+
+class ReadingTraceReader {
+public:
+    struct Record {
+        std::uint8_t kind = ReadingTraceWriter::READING;
+        VitalReading reading{VitalSign::HEART_RATE, 0.0, 0, MonitorClock::time_point()};
+        int age = 0;
+    };
+    
+    explicit ReadingTraceReader(const std::string& path)
+        : in(path, std::ios::binary), valid(false), corrupt(false), wallAnchorNanos(0), previousNanos(0) {
+        char magic[8];
+        std::uint32_t version = 0, reserved = 0;
+        if (!in.read(magic, sizeof(magic)) ||
+            std::memcmp(magic, ReadingTraceWriter::MAGIC, sizeof(magic)) != 0) return;
+        in.read(reinterpret_cast<char*>(&version), sizeof(version));
+        in.read(reinterpret_cast<char*>(&reserved), sizeof(reserved));
+        in.read(reinterpret_cast<char*>(&wallAnchorNanos), sizeof(wallAnchorNanos));
+        in.read(reinterpret_cast<char*>(&previousNanos), sizeof(previousNanos));
+        valid = in.good() && version == 1;
+    }
+    
+    bool isValid() const { return valid; }
+    
+    MonitorClock::time_point getStartTime() const {
+        return MonitorClock::time_point(MonitorClock::duration(previousNanos));
+    }
+    
+    // Returns false at end of trace; a truncated record, unknown record
+    // kind or out-of-range vital also ends it and marks the trace corrupt
+    bool next(Record& record) {
+        int kind = in.get();
+        if (kind == std::char_traits<char>::eof()) return false;
+        record.kind = static_cast<std::uint8_t>(kind);
+        
+        if (record.kind == ReadingTraceWriter::ADMISSION) {
+            record.reading.patientId = static_cast<int>(unzigzag(readVarint()));
+            record.age = static_cast<int>(readVarint());
+            return check(in.good());
+        }
+        if (record.kind != ReadingTraceWriter::READING) return check(false);
+        
+        previousNanos += unzigzag(readVarint());
+        record.reading.timestamp = MonitorClock::time_point(MonitorClock::duration(previousNanos));
+        record.reading.patientId = static_cast<int>(unzigzag(readVarint()));
+        int vital = in.get();
+        if (vital < 0 || vital >= static_cast<int>(VITAL_SIGN_COUNT)) return check(false);
+        record.reading.type = static_cast<VitalSign>(vital);
+        char bytes[sizeof(double)];
+        in.read(bytes, sizeof(double));
+        std::memcpy(&record.reading.value, bytes, sizeof(double));
+        return check(in.good());
+    }
+    
+    bool isCorrupt() const { return corrupt; }
+    
+private:
+    std::ifstream in;
+    bool valid;
+    bool corrupt;
+    std::int64_t wallAnchorNanos;
+    MonitorClock::rep previousNanos;
+    
+    bool check(bool ok) {
+        corrupt |= !ok;
+        return ok;
+    }
+    
+    static std::int64_t unzigzag(std::uint64_t v) {
+        return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+    }
+    
+    std::uint64_t readVarint() {
+        std::uint64_t result = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            int byte = in.get();
+            if (byte == std::char_traits<char>::eof()) break;
+            result |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) break;
+        }
+        return result;
+    }
+};
+
+// Result of an event-driven simulation run
+struct SimulationReport {
+    long readingsGenerated;
+    long alertsProcessed;
+    double simulatedSeconds;
+    double wallSeconds;
+};
+
+// Chunked arena with stable addresses
+// Objects live contiguously in fixed-size chunks that are never moved, so
+// pointers stay valid as the arena grows; freed slots are reused first.
+template <typename T, size_t CHUNK_SIZE = 256>
+class StableArena {
+public:
+    static constexpr std::uint32_t NONE = 0xFFFFFFFFu;
+    
+    StableArena() : liveCount(0), nextFresh(0) {}
+    StableArena(const StableArena&) = delete;
+    StableArena& operator=(const StableArena&) = delete;
+    
+    ~StableArena() {
+        forEachSlot([this](std::uint32_t slot) { get(slot)->~T(); });
+    }
+    
+    template <typename... Args>
+    std::uint32_t emplace(Args&&... args) {
+        std::uint32_t slot;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            slot = nextFresh++;
+            if (slot / CHUNK_SIZE >= chunks.size()) {
+                chunks.push_back(std::make_unique<Chunk>());
+            }
+        }
+        Chunk& chunk = *chunks[slot / CHUNK_SIZE];
+        new (chunk.storage + (slot % CHUNK_SIZE) * sizeof(T)) T(std::forward<Args>(args)...);
+        chunk.live[slot % CHUNK_SIZE] = true;
+        liveCount++;
+        return slot;
+    }
+    
+    void erase(std::uint32_t slot) {
+        Chunk& chunk = *chunks[slot / CHUNK_SIZE];
+        get(slot)->~T();
+        chunk.live[slot % CHUNK_SIZE] = false;
+        freeSlots.push_back(slot);
+        liveCount--;
+    }
+    
+    T* get(std::uint32_t slot) {
+        Chunk& chunk = *chunks[slot / CHUNK_SIZE];
+        return std::launder(reinterpret_cast<T*>(chunk.storage + (slot % CHUNK_SIZE) * sizeof(T)));
+    }
+    
+    size_t size() const { return liveCount; }
+    
+    // Visits live objects in slot order
+    template <typename Func>
+    void forEach(Func&& func) {
+        forEachSlot([this, &func](std::uint32_t slot) { func(*get(slot)); });
+    }
+    
+private:
+    struct Chunk {
+        alignas(T) unsigned char storage[CHUNK_SIZE * sizeof(T)];
+        bool live[CHUNK_SIZE] = {};
+    };
+    
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    std::vector<std::uint32_t> freeSlots;
+    size_t liveCount;
+    std::uint32_t nextFresh;
+    
+    template <typename Func>
+    void forEachSlot(Func&& func) {
+        for (std::uint32_t slot = 0; slot < nextFresh; ++slot) {
+            if (chunks[slot / CHUNK_SIZE]->live[slot % CHUNK_SIZE]) func(slot);
+        }
+    }
+};
+
+// Flat open-addressing index from patient id to arena slot
+// 8-byte entries with linear probing and backward-shift deletion; at 100k
+// patients the whole index is ~1-2 MB and stays cache-resident, so a reading
+// costs one probe into the index and one miss into the patient itself.
+class PatientIndex {
+public:
+    static constexpr std::uint32_t NONE = 0xFFFFFFFFu;
+    
+    PatientIndex() : entries(INITIAL_CAPACITY, Entry{EMPTY_KEY, NONE}), count(0) {}
+    
+    std::uint32_t find(int patientId) const {
+        size_t mask = entries.size() - 1;
+        for (size_t i = hashId(patientId) & mask; ; i = (i + 1) & mask) {
+            if (entries[i].key == patientId) return entries[i].slot;
+            if (entries[i].key == EMPTY_KEY) return NONE;
+        }
+    }
+    
+    void insert(int patientId, std::uint32_t slot) {
+        if ((count + 1) * 2 > entries.size()) grow();
+        size_t mask = entries.size() - 1;
+        size_t i = hashId(patientId) & mask;
+        while (entries[i].key != EMPTY_KEY && entries[i].key != patientId) {
+            i = (i + 1) & mask;
+        }
+        if (entries[i].key == EMPTY_KEY) count++;
+        entries[i] = Entry{patientId, slot};
+    }
+    
+    bool erase(int patientId) {
+        size_t mask = entries.size() - 1;
+        size_t i = hashId(patientId) & mask;
+        while (entries[i].key != patientId) {
+            if (entries[i].key == EMPTY_KEY) return false;
+            i = (i + 1) & mask;
+        }
+        entries[i].key = EMPTY_KEY;
+        count--;
+        
+        // Backward-shift the rest of the cluster
+        for (size_t next = (i + 1) & mask; entries[next].key != EMPTY_KEY; next = (next + 1) & mask) {
+            size_t home = hashId(entries[next].key) & mask;
+            if (((next - home) & mask) >= ((next - i) & mask)) {
+                entries[i] = entries[next];
+                entries[next].key = EMPTY_KEY;
+                i = next;
+            }
+        }
+        return true;
+    }
+    
+    size_t size() const { return count; }
+    
+private:
+    static constexpr size_t INITIAL_CAPACITY = 64;
+    static constexpr int EMPTY_KEY = std::numeric_limits<int>::min(); // reserved id
+    
+    struct Entry {
+        int key;
+        std::uint32_t slot;
+    };
+    
+    std::vector<Entry> entries;
+    size_t count;
+    
+    static size_t hashId(int patientId) {
+        std::uint32_t h = static_cast<std::uint32_t>(patientId);
+        h ^= h >> 16;
+        h *= 0x7FEB352Du;
+        h ^= h >> 15;
+        h *= 0x846CA68Bu;
+        h ^= h >> 16;
+        return h;
+    }
+    
+    void grow() {
+        std::vector<Entry> old(entries.size() * 2, Entry{EMPTY_KEY, NONE});
+        old.swap(entries);
+        count = 0;
+        for (const auto& entry : old) {
+            if (entry.key != EMPTY_KEY) insert(entry.key, entry.slot);
+        }
+    }
+};
+
+// Bulk admission source for large units
+// A census is plain "id,name,age" lines (blank lines and '#' comments are
+// skipped), or a generated ward with default names and ages. Ids are
+// positive and unique within a census.
+struct CensusEntry {
+    int id;
+    std::string name;
+    int age;
+};
+
+class Census {
+public:
+    // Returns false with 'error' describing the first bad line
+    static bool parse(std::istream& in, std::vector<CensusEntry>& out, std::string& error) {
+        std::string line;
+        int lineNumber = 0;
+        std::unordered_set<int> seen;
+        while (std::getline(in, line)) {
+            lineNumber++;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty() || line[0] == '#') continue;
+            
+            std::stringstream fields(line);
+            std::string idField, name, ageField;
+            if (!std::getline(fields, idField, ',') || !std::getline(fields, name, ',') ||
+                !std::getline(fields, ageField)) {
+                error = "line " + std::to_string(lineNumber) + ": expected id,name,age";
+                return false;
+            }
+            try {
+                long long id = std::stoll(idField);
+                int age = std::stoi(ageField);
+                if (id <= 0 || id > std::numeric_limits<int>::max() || age < 0 || age > 120) {
+                    throw std::out_of_range("census field");
+                }
+                if (!seen.insert(static_cast<int>(id)).second) {
+                    error = "line " + std::to_string(lineNumber) + ": duplicate id " + std::to_string(id);
+                    return false;
+                }
+                out.push_back(CensusEntry{static_cast<int>(id), name, age});
+            } catch (const std::exception&) {
+                error = "line " + std::to_string(lineNumber) + ": invalid id or age";
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    static bool load(const std::string& path, std::vector<CensusEntry>& out, std::string& error) {
+        std::ifstream in(path);
+        if (!in) {
+            error = "cannot open " + path;
+            return false;
+        }
+        return parse(in, out, error);
+    }
+    
+    static std::vector<CensusEntry> generate(int count, int firstId = 1) {
+        std::vector<CensusEntry> ward;
+        ward.reserve(static_cast<size_t>(std::max(0, count)));
+        for (int i = 0; i < count; ++i) {
+            int id = firstId + i;
+            ward.push_back(CensusEntry{id, "Patient_" + std::to_string(id), 30 + (rand() % 50)});
+        }
+        return ward;
+    }
+};
+
+// Hospital Scheduler (simplified)
+// Single ingestion thread: readings, batches, simulations, admissions,
+// discharges, alert processing and every ward-level query (distributions,
+// risk index, score distribution, statistics) must run on one thread. They
+// share the ward sketches, risk index, score distribution, coalescer and
+// batch buffers without locks. Patient locks exist only so the per-patient
+// queries marked thread-safe below can run on other threads alongside it.
+class HospitalScheduler {
+private:
+    StableArena<Patient> patients;
+    PatientIndex patientIndex;
+    RiskIndex riskIndex;
+    std::array<size_t, EarlyWarningScore::MAX_SCORE + 1> scoreDistribution;   // patients per NEWS2 score
+    long scoreAlertsRaised;
+    std::vector<WindowedSketch> wardDistributions;   // per vital, last 30-60 min
+    DeviceTable devices;
+    std::unordered_map<int, std::vector<DeviceTable::DeviceId>> patientDevices;
+    std::vector<VitalReading> pollBuffer;
+    std::map<int, std::shared_ptr<PatientPhysiology>> physiologies;
+    std::unique_ptr<AlertProcessor> alertProcessor;
+    AlertCoalescer coalescer;
+    long alertsCoalesced;
+    FalseAlarmDetector falseAlarmFilter;
+    ConfirmationPolicy confirmationPolicy;
+    long alertsPending;   // abnormal readings held back by confirmation
+    std::unique_ptr<ReadingTraceWriter> recorder;
+    SampleEventQueue* runEvents;   // calendar of the event-driven run in progress, if any
+    
+    // Alerts raised inside processBatch, enqueued in bulk at its end
+    bool batching;
+    std::vector<std::shared_ptr<Alert>> batchAlerts;
+    std::unordered_map<std::uint64_t, std::shared_ptr<Alert>> batchAlertsById;
+    
+public:
+    HospitalScheduler() : scoreDistribution{}, scoreAlertsRaised(0),
+                          wardDistributions(VITAL_SIGN_COUNT, WindowedSketch(std::chrono::minutes(30))),
+                          alertsCoalesced(0), confirmationPolicy(ConfirmationPolicy::standard()),
+                          alertsPending(0), runEvents(nullptr), batching(false) {
+        alertProcessor = std::make_unique<AlertProcessor>();
+    }
+    
+    void addPatient(std::unique_ptr<Patient> patient, bool attachDevices = true) {
+        int patientId = patient->getId();
+        if (recorder) recorder->writeAdmission(patientId, patient->getAge());
+        
+        // Re-admitting an id replaces the record: the old one is released
+        // like a discharge (devices detached, open alerts closed) first
+        releasePatient(patientId);
+        std::uint32_t slot = patients.emplace(std::move(*patient));
+        patientIndex.insert(patientId, slot);
+        riskIndex.insert(*patients.get(slot));
+        scoreDistribution[patients.get(slot)->getEarlyWarning().getScore()]++;
+        
+        // Create monitoring devices for this patient (not needed for replays)
+        if (attachDevices) {
+            createDevicesForPatient(patientId);
+        }
+    }
+    
+    void createDevicesForPatient(int patientId) {
+        // One device per vital sign, sharing the patient's physiology;
+        // a re-admitted patient gets a fresh set
+        detachPatientDevices(patientId);
+        physiologies[patientId] = std::make_shared<PatientPhysiology>(patientId);
+        for (size_t v = 0; v < VITAL_SIGN_COUNT; ++v) {
+            attachDevice(patientId, static_cast<VitalSign>(v));
+        }
+    }
+    
+    // Attaches a monitor to an admitted patient; INVALID_ID if unknown.
+    // During an event-driven run it starts sampling in that run.
+    DeviceTable::DeviceId attachDevice(int patientId, VitalSign vital) {
+        auto it = physiologies.find(patientId);
+        if (it == physiologies.end()) return DeviceTable::INVALID_ID;
+        DeviceTable::DeviceId id = devices.attach(vital, patientId, it->second);
+        if (id == DeviceTable::INVALID_ID) return id;
+        patientDevices[patientId].push_back(id);
+        if (runEvents) runEvents->schedule(MonitorClock::now() + initialPhase(id), id);
+        return id;
+    }
+    
+    bool detachDevice(DeviceTable::DeviceId id) {
+        if (!devices.contains(id)) return false;
+        forgetDevice(devices.getPatientId(id), id);
+        return devices.detach(id);
+    }
+    
+    // Moves a monitor to another admitted patient, keeping its id
+    bool reassignDevice(DeviceTable::DeviceId id, int patientId) {
+        auto it = physiologies.find(patientId);
+        if (it == physiologies.end() || !devices.contains(id)) return false;
+        forgetDevice(devices.getPatientId(id), id);
+        patientDevices[patientId].push_back(id);
+        return devices.reassign(id, patientId, it->second);
+    }
+    
+    size_t detachPatientDevices(int patientId) {
+        auto it = patientDevices.find(patientId);
+        if (it == patientDevices.end()) return 0;
+        size_t count = it->second.size();
+        for (DeviceTable::DeviceId id : it->second) {
+            devices.detach(id);
+        }
+        patientDevices.erase(it);
+        return count;
+    }
+    
+    std::vector<DeviceTable::DeviceId> getPatientDevices(int patientId) const {
+        auto it = patientDevices.find(patientId);
+        return it == patientDevices.end() ? std::vector<DeviceTable::DeviceId>() : it->second;
+    }
+    
+    // Pauses or resumes a device without detaching it; a paused device keeps
+    // its sampling schedule, so it resumes mid-run
+    bool setDeviceActive(DeviceTable::DeviceId id, bool active) {
+        if (!devices.contains(id)) return false;
+        devices.setActive(id, active);
+        return true;
+    }
+    
+    // Releases the patient's devices, open alerts and history. Open alerts
+    // are closed, not acknowledged, and their queued notifications dropped.
+    // The history slab goes back to the pool whole, so cost does not grow
+    // with the stay.
+    bool dischargePatient(int patientId) {
+        return releasePatient(patientId) != nullptr;
+    }
+    
+    // Moves a patient, history included, to another unit's scheduler; the
+    // devices and open alerts here are released with the bed
+    bool transferPatient(int patientId, HospitalScheduler& destination) {
+        if (&destination == this) return false;
+        std::unique_ptr<Patient> patient = releasePatient(patientId);
+        if (!patient) return false;
+        destination.addPatient(std::move(patient));
+        return true;
+    }
+    
+    size_t getPatientCount() const { return patients.size(); }
+    
+    bool hasPatient(int patientId) const {
+        return patientIndex.find(patientId) != PatientIndex::NONE;
+    }
+    
+    // Admits the census entries not already in the unit; returns the number
+    // admitted. Non-positive and repeated ids are skipped and, if 'skipped'
+    // is given, appended to it.
+    size_t admitCensus(const std::vector<CensusEntry>& census, std::vector<int>* skipped = nullptr) {
+        size_t admitted = 0;
+        for (const auto& entry : census) {
+            if (entry.id <= 0 || hasPatient(entry.id)) {
+                if (skipped) skipped->push_back(entry.id);
+                continue;
+            }
+            addPatient(std::make_unique<Patient>(entry.id, entry.name, entry.age));
+            admitted++;
+        }
+        return admitted;
+    }
+    
+    // Scripts a deterioration course for a patient's simulated signals
+    bool scheduleDeterioration(int patientId, DeteriorationProfile profile,
+                               MonitorClock::duration delay, MonitorClock::duration ramp) {
+        auto it = physiologies.find(patientId);
+        if (it == physiologies.end()) return false;
+        it->second->scheduleDeterioration(profile, MonitorClock::now() + delay, ramp);
+        return true;
+    }
+    
+    void simulateMonitoringCycle() {
+        // Generate readings one vital type at a time and process them
+        auto now = MonitorClock::now();
+        for (size_t v = 0; v < VITAL_SIGN_COUNT; ++v) {
+            pollBuffer.clear();
+            devices.poll(static_cast<VitalSign>(v), now, pollBuffer);
+            for (const auto& reading : pollBuffer) {
+                processVitalReading(reading);
+            }
+        }
+        
+        // Process all generated alerts
+        alertProcessor->processAllAlerts();
+    }
+    
+    // Ingestion thread only. It holds the patient's lock while it updates
+    // and evaluates the patient; the scheduler-wide state it also updates is
+    // not guarded. Under the patient lock only the alert processor's wheel
+    // and table locks are taken, and queries take nothing under a patient
+    // lock, so the order patient -> wheel -> table shard cannot cycle.
+    void processVitalReading(const VitalReading& reading) {
+        if (recorder) recorder->writeReading(reading);
+        
+        Patient* patient = findPatient(reading.patientId);
+        if (!patient) return;
+        
+        auto lock = patient->lockState();
+        Patient::UpdateScope update(*patient);
+        patient->addVitalReading(reading);
+        wardDistributions[static_cast<size_t>(reading.type)].update(reading.value, reading.timestamp);
+        
+        // Assess risk and create alerts if necessary
+        Priority risk = patient->assessRisk(reading);
+        evaluateReading(*patient, reading, risk);
+    }
+    
+    // Frame of readings as delivered by a monitor gateway. Readings are
+    // grouped by (patient, vital) keeping arrival order within a group; each
+    // group does one patient lookup and one batch risk classification
+    // (redone for the remainder whenever the learned range moves), and all
+    // resulting alerts are enqueued together.
+    void processBatch(const VitalReading* readings, size_t count) {
+        if (count == 0) return;
+        if (recorder) {
+            for (size_t i = 0; i < count; ++i) recorder->writeReading(readings[i]);
+        }
+        
+        std::vector<std::uint32_t> order(count);
+        for (size_t i = 0; i < count; ++i) order[i] = static_cast<std::uint32_t>(i);
+        std::stable_sort(order.begin(), order.end(), [readings](std::uint32_t a, std::uint32_t b) {
+            if (readings[a].patientId != readings[b].patientId) return readings[a].patientId < readings[b].patientId;
+            return readings[a].type < readings[b].type;
+        });
+        
+        batching = true;
+        std::vector<double> values;
+        std::vector<Priority> risks;
+        size_t groupStart = 0;
+        while (groupStart < count) {
+            const VitalReading& head = readings[order[groupStart]];
+            size_t groupEnd = groupStart + 1;
+            while (groupEnd < count && readings[order[groupEnd]].patientId == head.patientId &&
+                   readings[order[groupEnd]].type == head.type) {
+                groupEnd++;
+            }
+            
+            if (Patient* found = findPatient(head.patientId)) {
+                Patient& patient = *found;
+                auto lock = patient.lockState();
+                Patient::UpdateScope update(patient);
+                size_t groupSize = groupEnd - groupStart;
+                values.resize(groupSize);
+                risks.resize(groupSize);
+                for (size_t i = 0; i < groupSize; ++i) values[i] = readings[order[groupStart + i]].value;
+                auto range = patient.getNormalRange(head.type);
+                Patient::classifyRisk(head.type, values.data(), groupSize, range, risks.data());
+                
+                for (size_t i = 0; i < groupSize; ++i) {
+                    const VitalReading& reading = readings[order[groupStart + i]];
+                    patient.addVitalReading(reading);
+                    wardDistributions[static_cast<size_t>(reading.type)].update(reading.value, reading.timestamp);
+                    evaluateReading(patient, reading, risks[i]);
+                    
+                    // A warm baseline can move the range after any reading;
+                    // reclassify the rest of the group as single ingestion would
+                    auto updated = patient.getNormalRange(head.type);
+                    if (updated != range && i + 1 < groupSize) {
+                        range = updated;
+                        Patient::classifyRisk(head.type, values.data() + i + 1, groupSize - i - 1, range, risks.data() + i + 1);
+                    }
+                }
+            }
+            groupStart = groupEnd;
+        }
+        batching = false;
+        
+        alertProcessor->addAlerts(batchAlerts);
+        batchAlerts.clear();
+        batchAlertsById.clear();
+    }
+    
+    void processBatch(const std::vector<VitalReading>& readings) {
+        processBatch(readings.data(), readings.size());
+    }
+    
+    void runSimulation(int cycles) {
+        std::cout << "Starting monitoring simulation for " << cycles << " cycles..." << std::endl;
+        
+        for (int i = 0; i < cycles; ++i) {
+            std::cout << "\n--- Cycle " << (i + 1) << " ---" << std::endl;
+            simulateMonitoringCycle();
+            
+            // Small delay to see output
+            #ifdef _WIN32
+                system("timeout /t 1 /nobreak > nul 2>&1");
+            #else
+                system("sleep 1");
+            #endif
+        }
+    }
+    
+    // Event-driven run on virtual time: every device is sampled at its own
+    // rate from a calendar queue, with no wall-clock sleeps, so long shifts
+    // can be simulated as fast as the CPU allows
+    SimulationReport runEventDrivenSimulation(MonitorClock::duration simulatedSpan) {
+        bool ownsClock = !MonitorClock::isSimulated();
+        if (ownsClock) {
+            MonitorClock::useSimulatedTime(MonitorClock::now());
+        }
+        
+        auto wallStart = std::chrono::steady_clock::now();
+        auto simStart = MonitorClock::now();
+        auto simEnd = simStart + simulatedSpan;
+        long alertsBefore = alertProcessor->getTotalAlertsProcessed();
+        long readings = 0;
+        
+        // Paused devices are scheduled too, and devices attached during the
+        // run join it, so pause, resume and attach take effect mid-run
+        SampleEventQueue events;
+        devices.forEachAttached([&](DeviceTable::DeviceId id) {
+            events.schedule(simStart + initialPhase(id), id);
+        });
+        runEvents = &events;
+        
+        std::vector<SampleEventQueue::Event> window;
+        std::vector<VitalReading> frame;
+        while (events.popNextWindow(window)) {
+            if (window.front().time >= simEnd) break;
+            
+            // Each calendar window is ingested as one gateway frame
+            frame.clear();
+            for (const auto& event : window) {
+                if (event.time >= simEnd) break;
+                DeviceTable::DeviceId id = event.deviceIndex;
+                if (!devices.contains(id)) continue;   // detached; its schedule ends
+                
+                MonitorClock::advanceTo(event.time);
+                if (devices.isActive(id)) {
+                    frame.push_back(devices.generate(id, event.time));
+                }
+                events.schedule(event.time + devices.getSamplingInterval(id), id);
+            }
+            readings += static_cast<long>(frame.size());
+            processBatch(frame);
+            alertProcessor->processAllAlerts();
+        }
+        
+        runEvents = nullptr;
+        MonitorClock::advanceTo(simEnd);
+        alertProcessor->waitForHandlers();
+        if (ownsClock) {
+            MonitorClock::useRealTime();
+        }
+        
+        SimulationReport report;
+        report.readingsGenerated = readings;
+        report.alertsProcessed = alertProcessor->getTotalAlertsProcessed() - alertsBefore;
+        report.simulatedSeconds = std::chrono::duration<double>(simulatedSpan).count();
+        report.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        return report;
+    }
+    
+    void setVerbose(bool enabled) { alertProcessor->setVerbose(enabled); }
+    bool isVerbose() const { return alertProcessor->isVerbose(); }
+    
+    // Captures admissions and every reading received from now on
+    bool startRecording(const std::string& path) {
+        recorder = std::make_unique<ReadingTraceWriter>(path, [this](std::function<void()> task) {
+            runInBackground(std::move(task));
+        });
+        if (!recorder->isOpen()) {
+            recorder.reset();
+            return false;
+        }
+        patients.forEach([this](Patient& patient) {
+            recorder->writeAdmission(patient.getId(), patient.getAge());
+        });
+        return true;
+    }
+    
+    long stopRecording() {
+        long count = recorder ? recorder->getReadingCount() : 0;
+        recorder.reset();
+        return count;
+    }
+    
+    void processPendingAlerts() { alertProcessor->processAllAlerts(); }
+    
+    void setAlertLog(std::ostream* log, MonitorClock::time_point epoch) {
+        alertProcessor->setAlertLog(log, epoch);
+    }
+    
+    bool acknowledgeAlert(std::uint64_t alertId) {
+        return alertProcessor->acknowledgeAlert(alertId);
+    }
+    
+    size_t acknowledgePatientAlerts(int patientId) {
+        return alertProcessor->acknowledgePatientAlerts(patientId);
+    }
+    
+    std::vector<std::shared_ptr<Alert>> getOpenAlerts(int patientId) {
+        return alertProcessor->getOpenAlerts(patientId);
+    }
+    
+    long getAlertsCoalesced() const { return alertsCoalesced; }
+    long getScoreAlertsRaised() const { return scoreAlertsRaised; }
+    long getFalseAlarmsFiltered() const { return alertProcessor->getFalseAlarmsFiltered(); }
+    
+    // Detector pipeline applied to non-CRITICAL reading alerts
+    FalseAlarmDetector& getFalseAlarmFilter() { return falseAlarmFilter; }
+    
+    // Alert handlers on a work-stealing pool with a CRITICAL lane (0 = inline)
+    void setDispatchWorkers(size_t workers, const DispatchLaneOptions& lanes = DispatchLaneOptions()) {
+        alertProcessor->setDispatchWorkers(workers, lanes);
+    }
+    const AlertDispatcher* getAlertDispatcher() const { return alertProcessor->getDispatcher(); }
+    void runInBackground(std::function<void()> task) { alertProcessor->runInBackground(std::move(task)); }
+    void setAlertHandler(std::function<void(const Alert&)> handler) { alertProcessor->setAlertHandler(std::move(handler)); }
+    void waitForAlertHandlers() { alertProcessor->waitForHandlers(); }
+    
+    // K-of-N rules abnormal readings must meet before they alert
+    void setConfirmationPolicy(const ConfirmationPolicy& policy) { confirmationPolicy = policy; }
+    const ConfirmationPolicy& getConfirmationPolicy() const { return confirmationPolicy; }
+    long getAlertsPending() const { return alertsPending; }
+    
+    // Admitted patients per current NEWS2 score (index = score)
+    const std::array<size_t, EarlyWarningScore::MAX_SCORE + 1>& getScoreDistribution() const {
+        return scoreDistribution;
+    }
+    
+    // Ward-wide distribution of one vital over the last 30-60 minutes;
+    // snapshots from several schedulers merge with KllSketch::merge.
+    // Ingestion thread only: taking a snapshot rotates expired windows.
+    KllSketch getWardDistribution(VitalSign vital) {
+        return wardDistributions[static_cast<size_t>(vital)].snapshot(MonitorClock::now());
+    }
+    
+    double getWardQuantile(VitalSign vital, double q) {
+        return getWardDistribution(vital).quantile(q);
+    }
+    
+    // Where 'value' ranks among the patient's own last 12-24 h (0..1, NaN if
+    // unknown). Thread-safe like the per-patient queries below, but not
+    // lock-free: it copies the patient's window under the patient's lock
+    // (ingestion waits at most for that short copy) and merges and ranks
+    // after releasing it.
+    double getPatientPercentile(int patientId, VitalSign vital, double value) {
+        Patient* patient = findPatient(patientId);
+        if (!patient) return std::numeric_limits<double>::quiet_NaN();
+        WindowedSketch window(Patient::DISTRIBUTION_EPOCH, Patient::DISTRIBUTION_K);
+        {
+            auto lock = patient->lockState();
+            window = patient->recentDistribution(vital);
+        }
+        return window.snapshot(MonitorClock::now()).rank(value);
+    }
+    
+    // Ward sketches for every vital, in VitalSign order
+    void writeDistributionSnapshot(std::ostream& out) {
+        for (size_t v = 0; v < VITAL_SIGN_COUNT; ++v) {
+            getWardDistribution(static_cast<VitalSign>(v)).serialize(out);
+        }
+    }
+    
+    static bool readDistributionSnapshot(std::istream& in, std::vector<KllSketch>& sketches) {
+        sketches.assign(VITAL_SIGN_COUNT, KllSketch());
+        for (auto& sketch : sketches) {
+            if (!KllSketch::deserialize(in, sketch)) return false;
+        }
+        return true;
+    }
+    
+    // Thread-safe: the per-patient queries below may run on other threads
+    // while readings are ingested, but not while patients are admitted or
+    // discharged. They are lock-free, so dashboards polling them never hold
+    // up ingestion. getPatientSnapshot reads all of a patient's published
+    // state as of one completed ingestion step; the single-value getters
+    // are each consistent only on their own.
+    bool getPatientSnapshot(int patientId, PatientSnapshot& out, int count = 10) {
+        Patient* patient = findPatient(patientId);
+        if (!patient) return false;
+        out = patient->snapshot(static_cast<size_t>(std::max(0, count)));
+        return true;
+    }
+    
+    int getEarlyWarningScore(int patientId) {
+        Patient* patient = findPatient(patientId);
+        return patient ? patient->getEarlyWarningScore() : -1;
+    }
+    
+    std::vector<VitalReading> getRecentReadings(int patientId, VitalSign vital, int count = 10) {
+        Patient* patient = findPatient(patientId);
+        return patient ? patient->getRecentReadings(vital, count) : std::vector<VitalReading>();
+    }
+    
+    // Current composite risk, LOW for unknown patients
+    Priority getPatientRisk(int patientId) {
+        Patient* patient = findPatient(patientId);
+        return patient ? patient->getCurrentRisk() : Priority::LOW;
+    }
+    
+    void printOpenAlerts(int patientId) {
+        auto open = alertProcessor->getOpenAlerts(patientId);
+        std::cout << "\n=== Open Alerts for Patient " << patientId << " ===" << std::endl;
+        if (open.empty()) {
+            std::cout << "None" << std::endl;
+        }
+        for (const auto& alert : open) {
+            std::cout << "#" << alert->alertId << " | " << priorityToString(alert->priority)
+                      << " | " << alert->message;
+            if (alert->occurrenceCount > 1) {
+                std::cout << " | x" << alert->occurrenceCount << " (worst " << alert->worstValue << ")";
+            }
+            if (alert->escalationLevel > 0) {
+                std::cout << " | escalated x" << alert->escalationLevel;
+            }
+            if (alert->expired) {
+                std::cout << " | expired, still unacknowledged";
+            }
+            std::cout << std::endl;
+        }
+    }
+    
+    // One page of the census in id order; 'page' is zero-based
+    void printPatientInfo(size_t page = 0, size_t pageSize = 50) {
+        std::vector<const Patient*> ordered;
+        ordered.reserve(patients.size());
+        patients.forEach([&ordered](Patient& patient) { ordered.push_back(&patient); });
+        std::sort(ordered.begin(), ordered.end(), [](const Patient* a, const Patient* b) {
+            return a->getId() < b->getId();
+        });
+        
+        size_t pageCount = std::max<size_t>(1, (ordered.size() + pageSize - 1) / pageSize);
+        page = std::min(page, pageCount - 1);
+        std::cout << "\n=== Current Patients (page " << (page + 1) << " of " << pageCount << ") ===" << std::endl;
+        size_t end = std::min(ordered.size(), (page + 1) * pageSize);
+        for (size_t i = page * pageSize; i < end; ++i) {
+            printPatientLine(*ordered[i]);
+        }
+    }
+    
+    // Ids of the k highest-risk patients, most urgent first; O(k)
+    std::vector<int> getHighestRiskPatients(size_t k) const {
+        std::vector<int> ids;
+        riskIndex.forEachMostAtRisk(k, [&ids](const Patient& patient) { ids.push_back(patient.getId()); });
+        return ids;
+    }
+    
+    // Every bed currently at 'risk', e.g. all CRITICAL beds
+    std::vector<int> getPatientsAtRisk(Priority risk) const {
+        std::vector<int> ids;
+        ids.reserve(riskIndex.count(risk));
+        riskIndex.forEachAt(risk, [&ids](const Patient& patient) { ids.push_back(patient.getId()); });
+        return ids;
+    }
+    
+    void printHighestRisk(size_t k = 10) {
+        std::cout << "\n=== Highest-Risk Patients ===" << std::endl;
+        riskIndex.forEachMostAtRisk(k, [this](const Patient& patient) { printPatientLine(patient); });
+    }
+    
+    // Patient counts indexed by Priority - 1
+    std::array<size_t, 4> getRiskCounts() const {
+        return {riskIndex.count(Priority::CRITICAL), riskIndex.count(Priority::HIGH),
+                riskIndex.count(Priority::MEDIUM), riskIndex.count(Priority::LOW)};
+    }
+    
+    void printStatistics() {
+        std::cout << "\n=== System Statistics ===" << std::endl;
+        std::cout << "Total Patients: " << patients.size() << std::endl;
+        auto risk = getRiskCounts();
+        std::cout << "Patients by Risk: Critical " << risk[0] << " | High " << risk[1]
+                  << " | Medium " << risk[2] << " | Low " << risk[3] << std::endl;
+        std::cout << "Total Devices: " << devices.size() << std::endl;
+        std::cout << "Alerts Processed: " << alertProcessor->getTotalAlertsProcessed() << std::endl;
+        std::cout << "False Alarms Filtered: " << alertProcessor->getFalseAlarmsFiltered();
+        const char* separator = " (";
+        for (const auto& entry : falseAlarmFilter.getFilteredCounts()) {
+            std::cout << separator << entry.first << " " << entry.second;
+            separator = ", ";
+        }
+        std::cout << (falseAlarmFilter.getDetectorCount() ? ")" : "") << std::endl;
+        std::cout << "Escalations: " << alertProcessor->getTotalEscalations()
+                  << " (expired unacknowledged: " << alertProcessor->getExpiredUnacknowledged() << ")" << std::endl;
+        std::cout << "Open Alerts: " << alertProcessor->getUnacknowledgedCount() << std::endl;
+        std::cout << "Repeats Coalesced: " << alertsCoalesced << std::endl;
+        std::cout << "Readings Held Pending Confirmation: " << alertsPending << std::endl;
+        
+        size_t bands[3] = {0, 0, 0};
+        double scoreSum = 0.0;
+        for (int score = 0; score <= EarlyWarningScore::MAX_SCORE; ++score) {
+            bands[score >= 7 ? 2 : (score >= 5 ? 1 : 0)] += scoreDistribution[score];
+            scoreSum += static_cast<double>(score) * scoreDistribution[score];
+        }
+        // Decimals are formatted locally so std::cout keeps its precision
+        std::ostringstream mean;
+        mean << std::fixed << std::setprecision(1) << (patients.size() > 0 ? scoreSum / patients.size() : 0.0);
+        std::cout << "NEWS2 Scores: 0-4 " << bands[0] << " | 5-6 " << bands[1] << " | 7+ " << bands[2]
+                  << " | mean " << mean.str() << std::endl;
+        std::cout << "Score Alerts Raised: " << scoreAlertsRaised << std::endl;
+        
+        for (size_t v = 0; v < VITAL_SIGN_COUNT; ++v) {
+            KllSketch ward = getWardDistribution(static_cast<VitalSign>(v));
+            if (ward.empty()) continue;
+            std::ostringstream quantiles;
+            quantiles << std::fixed << std::setprecision(1) << ward.quantile(0.05) << " / "
+                      << ward.quantile(0.5) << " / " << ward.quantile(0.95);
+            std::cout << "Ward " << vitalSignToString(static_cast<VitalSign>(v)) << " p5/p50/p95: "
+                      << quantiles.str() << std::endl;
+        }
+    }
+    
+private:
+    std::unique_ptr<Patient> releasePatient(int patientId) {
+        std::uint32_t slot = patientIndex.find(patientId);
+        if (slot == PatientIndex::NONE) return nullptr;
+        
+        unindexPatient(*patients.get(slot));
+        auto patient = std::make_unique<Patient>(std::move(*patients.get(slot)));
+        patients.erase(slot);
+        patientIndex.erase(patientId);
+        detachPatientDevices(patientId);
+        alertProcessor->closePatientAlerts(patientId);
+        physiologies.erase(patientId);
+        return patient;
+    }
+    
+    void unindexPatient(Patient& patient) {
+        riskIndex.remove(patient);
+        scoreDistribution[patient.getEarlyWarning().getScore()]--;
+    }
+    
+    void printPatientLine(const Patient& patient) {
+        std::cout << "ID: " << patient.getId() 
+                  << " | Name: " << patient.getName() 
+                  << " | Risk: " << priorityToString(patient.getCurrentRisk()) << std::endl;
+    }
+    
+    void forgetDevice(int patientId, DeviceTable::DeviceId id) {
+        auto it = patientDevices.find(patientId);
+        if (it == patientDevices.end()) return;
+        auto& ids = it->second;
+        ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+        if (ids.empty()) patientDevices.erase(it);
+    }
+    
+    Patient* findPatient(int patientId) {
+        std::uint32_t slot = patientIndex.find(patientId);
+        return slot == PatientIndex::NONE ? nullptr : patients.get(slot);
+    }
+    
+    // Alerting stage shared by single-reading and batch ingestion
+    void evaluateReading(Patient& patient, const VitalReading& reading, Priority risk) {
+        // Abnormal readings wait for K-of-N confirmation before they alert
+        Priority confirmed = patient.confirmRisk(reading.type, risk, confirmationPolicy);
+        if (confirmed == Priority::LOW && risk != Priority::LOW) {
+            alertsPending++;
+        }
+        
+        bool filtered = false;
+        if (confirmed != Priority::LOW) {
+            double deviation = patient.deviationFromNormal(reading);
+            auto key = AlertCoalescer::makeKey(reading.patientId, reading.type, confirmed, AlertCoalescer::Kind::READING);
+            std::shared_ptr<Alert> open = findCoalescable(key, reading.timestamp);
+            
+            std::string message = open ? open->message : generateAlertMessage(reading, confirmed);
+            auto alert = open ? open : std::make_shared<Alert>(reading.patientId, confirmed, message, reading.type);
+            
+            // Check for false alarm
+            if (const AlarmDetector* detector = falseAlarmFilter.judge(AlarmContext{*alert, reading, patient})) {
+                filtered = true;
+                alertProcessor->recordFalseAlarm();
+                if (alertProcessor->isVerbose()) {
+                    std::cout << "[FALSE ALARM FILTERED: " << detector->name() << "] Patient " << reading.patientId 
+                              << ": " << message << std::endl;
+                }
+            } else if (open) {
+                foldInto(*open, key, reading, deviation);
+            } else {
+                alert->worstValue = reading.value;
+                raiseAlert(alert);
+                coalescer.open(key, alert->alertId, reading.timestamp, deviation);
+            }
+        }
+        
+        // The aggregate score takes normal and confirmed values only: a
+        // pending or filtered reading keeps the vital's previous sub-score,
+        // so one artifact cannot cross a NEWS2 band on its own
+        const EarlyWarningScore& news = patient.getEarlyWarning();
+        bool accepted = (risk == Priority::LOW) || (confirmed != Priority::LOW && !filtered);
+        if (accepted) {
+            int scoreBefore = news.getScore();
+            EarlyWarningScore::Band bandBefore = news.getBand();
+            EarlyWarningScore::Band band = patient.updateEarlyWarning(reading.type, reading.value);
+            scoreDistribution[scoreBefore]--;
+            scoreDistribution[news.getScore()]++;
+            if (band > bandBefore) {
+                raiseScoreAlert(patient, reading);
+            }
+        }
+        
+        // A concerning trend holds the vital at MEDIUM or worse
+        bool trending = patient.detectTrend(reading.type);
+        patient.recordRisk(reading.type, trending ? std::min(risk, Priority::MEDIUM) : risk);
+        patient.updateBaseline(reading, risk);
+        riskIndex.update(patient);
+        
+        // Check for concerning trends
+        if (patient.confirmTrend(reading.type, trending, confirmationPolicy)) {
+            auto key = AlertCoalescer::makeKey(reading.patientId, reading.type, Priority::MEDIUM, AlertCoalescer::Kind::TREND);
+            if (std::shared_ptr<Alert> open = findCoalescable(key, reading.timestamp)) {
+                foldInto(*open, key, reading, 0.0);
+            } else {
+                std::string trendMessage = "Concerning trend detected in " + vitalSignToString(reading.type);
+                auto trendAlert = std::make_shared<Alert>(reading.patientId, Priority::MEDIUM, trendMessage, reading.type, AlertKind::TREND);
+                trendAlert->worstValue = reading.value;
+                raiseAlert(trendAlert);
+                coalescer.open(key, trendAlert->alertId, reading.timestamp, 0.0);
+            }
+        }
+    }
+    
+    // Upward crossing of a NEWS2 band; keyed per patient and band, so a
+    // score hovering on a boundary folds into one open alert
+    void raiseScoreAlert(const Patient& patient, const VitalReading& reading) {
+        const EarlyWarningScore& news = patient.getEarlyWarning();
+        Priority priority = EarlyWarningScore::alertPriority(news.getBand());
+        auto key = AlertCoalescer::makeKey(reading.patientId, priority, AlertCoalescer::Kind::SCORE);
+        if (std::shared_ptr<Alert> open = findCoalescable(key, reading.timestamp)) {
+            foldInto(*open, key, reading, news.getScore());
+            return;
+        }
+        
+        std::string message = "NEWS2 score " + std::to_string(news.getScore()) + " (" +
+                              EarlyWarningScore::bandName(news.getBand()) + " clinical risk, after " +
+                              vitalSignToString(reading.type) + ")";
+        auto alert = std::make_shared<Alert>(reading.patientId, priority, message, reading.type, AlertKind::SCORE);
+        alert->worstValue = reading.value;
+        raiseAlert(alert);
+        coalescer.open(key, alert->alertId, reading.timestamp, news.getScore());
+        scoreAlertsRaised++;
+    }
+    
+    void raiseAlert(const std::shared_ptr<Alert>& alert) {
+        if (batching) {
+            batchAlerts.push_back(alert);
+            batchAlertsById[alert->alertId] = alert;
+        } else {
+            alertProcessor->addAlert(alert);
+        }
+    }
+    
+    // Open alert to fold this condition into, if it is still unacknowledged
+    // and has not been quiet for longer than the coalescing window
+    std::shared_ptr<Alert> findCoalescable(std::uint64_t key, MonitorClock::time_point now) {
+        std::uint64_t alertId = coalescer.findOpen(key, now);
+        if (alertId == 0) return nullptr;
+        
+        std::shared_ptr<Alert> open = alertProcessor->findOpenAlert(alertId);
+        if (!open && batching) {
+            // Raised earlier in this batch, not yet enqueued
+            auto pending = batchAlertsById.find(alertId);
+            if (pending != batchAlertsById.end()) open = pending->second;
+        }
+        if (!open) {
+            coalescer.close(key);
+        }
+        return open;
+    }
+    
+    void foldInto(Alert& open, std::uint64_t key, const VitalReading& reading, double deviation) {
+        open.occurrenceCount++;
+        open.lastSeen = reading.timestamp;
+        if (coalescer.fold(key, reading.timestamp, deviation)) {
+            open.worstValue = reading.value;
+        }
+        alertsCoalesced++;
+    }
+    
+    // Deterministic per-device phase within its sampling interval, so devices
+    // with the same rate do not all fire on the same virtual instant
+    MonitorClock::duration initialPhase(DeviceTable::DeviceId id) const {
+        auto interval = devices.getSamplingInterval(id);
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(interval).count();
+        if (seconds <= 1) return MonitorClock::duration::zero();
+        return std::chrono::seconds((id * 7919L) % seconds);
+    }
+    
+    std::string generateAlertMessage(const VitalReading& reading, Priority priority) {
+        std::string vital = vitalSignToString(reading.type);
+        return vital + " reading: " + std::to_string(static_cast<int>(reading.value)) + 
+               " (Priority: " + std::to_string(static_cast<int>(priority)) + ")";
+    }
+    
+    std::string vitalSignToString(VitalSign vital) {
+        switch (vital) {
+            case VitalSign::HEART_RATE: return "Heart Rate";
+            case VitalSign::BLOOD_PRESSURE: return "Blood Pressure";
+            case VitalSign::OXYGEN_SATURATION: return "Oxygen Saturation";
+            case VitalSign::TEMPERATURE: return "Temperature";
+            case VitalSign::RESPIRATORY_RATE: return "Respiratory Rate";
+            default: return "Unknown";
+        }
+    }
+    
+    std::string priorityToString(Priority p) {
+        switch (p) {
+            case Priority::CRITICAL: return "CRITICAL";
+            case Priority::HIGH: return "HIGH";
+            case Priority::MEDIUM: return "MEDIUM";
+            case Priority::LOW: return "LOW";
+            default: return "UNKNOWN";
+        }
+    }
+};
+
+// CRITICAL ingestion latency under concurrent patient queries
+// One thread ingests CRITICAL heart-rate readings round-robin over a small
+// ward, one every INTERVAL, while 'readers' threads copy the same
+// patients' recent history and risk in a tight loop the way dashboards
+// poll. Each processVitalReading call is timed, so the tail shows any
+// interference from readers (they read lock-free, so only cache and CPU
+// contention remain). Readers also check every snapshot is consistent:
+// one patient and vital, readings in time order.
+class PatientContentionBenchmark {
+public:
+    static constexpr int WARD = 4;
+    static constexpr std::chrono::microseconds INTERVAL{100};
+    
+    struct Report {
+        long readingsIngested = 0;
+        long snapshotsRead = 0;
+        long inconsistentSnapshots = 0;
+        bool priorityInheritance = false;
+        bool realtimeIngestion = false;   // ingestion ran as SCHED_FIFO
+        std::chrono::nanoseconds p50{0}, p99{0}, p999{0}, max{0};
+    };
+    
+    static Report run(int readers, std::chrono::milliseconds duration, bool realtime = false) {
+        using namespace std::chrono;
+        HospitalScheduler scheduler;
+        scheduler.setVerbose(false);
+        for (int id = 1; id <= WARD; ++id) {
+            scheduler.addPatient(std::make_unique<Patient>(id, "Bed " + std::to_string(id), 50), false);
+            for (size_t i = 0; i < HistorySlab::HISTORY_CAPACITY; ++i) {
+                scheduler.processVitalReading(VitalReading(VitalSign::HEART_RATE, 75.0, id));
+            }
+        }
+        
+        Report report;
+        report.priorityInheritance = PriorityInheritanceMutex().inheritsPriority();
+        LatencyHistogram latency;
+        std::atomic<bool> done(false);
+        std::atomic<long> snapshots(0);
+        std::atomic<long> inconsistent(0);
+        
+        std::vector<std::thread> threads;
+        for (int r = 0; r < readers; ++r) {
+            threads.emplace_back([&, r]() {
+                long reads = 0;
+                long bad = 0;
+                for (int id = 1 + r % WARD; !done.load(std::memory_order_relaxed); id = 1 + id % WARD) {
+                    std::vector<VitalReading> recent =
+                        scheduler.getRecentReadings(id, VitalSign::HEART_RATE, HistorySlab::HISTORY_CAPACITY);
+                    bool consistent = !recent.empty();
+                    for (size_t i = 0; i < recent.size(); ++i) {
+                        consistent &= recent[i].patientId == id && recent[i].type == VitalSign::HEART_RATE &&
+                                      (i == 0 || recent[i - 1].timestamp <= recent[i].timestamp);
+                    }
+                    bad += !consistent;
+                    scheduler.getPatientRisk(id);
+                    reads++;
+                }
+                snapshots += reads;
+                inconsistent += bad;
+            });
+        }
+        
+        std::thread ingest([&]() {
+#ifdef LANE_PLACEMENT
+            if (realtime) {
+                sched_param param{};
+                param.sched_priority = 50;
+                report.realtimeIngestion = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+            }
+#endif
+            auto start = steady_clock::now();
+            long count = 0;
+            for (auto next = start; steady_clock::now() - start < duration; next += INTERVAL) {
+                std::this_thread::sleep_until(next);
+                VitalReading reading(VitalSign::HEART_RATE, count % 2 ? 185.0 : 190.0, 1 + count % WARD);
+                auto begin = steady_clock::now();
+                scheduler.processVitalReading(reading);
+                latency.record(steady_clock::now() - begin);
+                if (++count % 1000 == 0) scheduler.processPendingAlerts();
+            }
+            report.readingsIngested = count;
+            done = true;
+        });
+        ingest.join();
+        for (auto& thread : threads) thread.join();
+        
+        report.snapshotsRead = snapshots.load();
+        report.inconsistentSnapshots = inconsistent.load();
+        report.p50 = latency.percentile(0.50);
+        report.p99 = latency.percentile(0.99);
+        report.p999 = latency.percentile(0.999);
+        report.max = latency.max();
+        return report;
+    }
+    
+    static void print(const Report& report, int readers) {
+        std::ostringstream row;
+        row << std::fixed << std::setprecision(1)
+            << std::setw(8) << readers
+            << std::setw(12) << report.readingsIngested
+            << std::setw(14) << report.snapshotsRead
+            << std::setw(12) << report.p50.count() / 1000.0
+            << std::setw(12) << report.p99.count() / 1000.0
+            << std::setw(12) << report.p999.count() / 1000.0
+            << std::setw(12) << report.max.count() / 1000.0
+            << (report.inconsistentSnapshots ? "  INCONSISTENT" : "");
+        std::cout << row.str() << std::endl;
+    }
+    
+    static void printHeader(const Report& report) {
+        std::cout << "Patient lock: " << (report.priorityInheritance ? "priority inheritance" : "plain mutex")
+                  << ", ingestion " << (report.realtimeIngestion ? "SCHED_FIFO" : "default scheduling") << std::endl;
+        std::cout << std::setw(8) << "Readers" << std::setw(12) << "Readings" << std::setw(14) << "Snapshots"
+                  << std::setw(12) << "p50 (us)" << std::setw(12) << "p99 (us)"
+                  << std::setw(12) << "p99.9 (us)" << std::setw(12) << "max (us)" << std::endl;
+    }
+};
+
+// Replays a recorded trace into a scheduler
+// Virtual time follows the recorded timestamps in every mode, so alert
+// output is identical whether the trace is paced at original speed, N times
+// faster, or pushed as fast as possible (speed <= 0). A corrupt trace is
+// replayed up to the bad record and reported as a failure.
+class TraceReplayer {
+public:
+    struct ReplayReport {
+        long readingsReplayed;
+        long patientsAdmitted;
+        double wallSeconds;
+    };
+    
+    static bool replay(HospitalScheduler& scheduler, const std::string& path, double speed,
+                       std::ostream* alertLog, ReplayReport& report) {
+        report = ReplayReport{0, 0, 0.0};
+        ReadingTraceReader reader(path);
+        if (!reader.isValid()) return false;
+        
+        bool ownsClock = !MonitorClock::isSimulated();
+        MonitorClock::useSimulatedTime(reader.getStartTime());
+        scheduler.setAlertLog(alertLog, reader.getStartTime());
+        
+        auto wallStart = std::chrono::steady_clock::now();
+        auto lastTime = reader.getStartTime();
+        ReadingTraceReader::Record record;
+        
+        while (reader.next(record)) {
+            if (record.kind == ReadingTraceWriter::ADMISSION) {
+                int id = record.reading.patientId;
+                scheduler.addPatient(std::make_unique<Patient>(id, "Patient_" + std::to_string(id), record.age), false);
+                report.patientsAdmitted++;
+                continue;
+            }
+            
+            if (record.reading.timestamp > lastTime) {
+                // Dispatch everything raised at the previous instant first
+                scheduler.processPendingAlerts();
+                lastTime = record.reading.timestamp;
+                if (speed > 0) {
+                    auto offset = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                        (lastTime - reader.getStartTime()) / speed);
+                    std::this_thread::sleep_until(wallStart + offset);
+                }
+                MonitorClock::advanceTo(lastTime);
+            }
+            scheduler.processVitalReading(record.reading);
+            report.readingsReplayed++;
+        }
+        scheduler.processPendingAlerts();
+        scheduler.setAlertLog(nullptr, MonitorClock::time_point());
+        
+        if (ownsClock) {
+            MonitorClock::useRealTime();
+        }
+        report.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        return !reader.isCorrupt();
+    }
+};
+
+// Test Framework
+class TestFramework {
+public:
+    static void runAllTests() {
+        std::cout << "\n=== Running Unit Tests ===" << std::endl;
+        
+        testPatientCreation();
+        testVitalReadingProcessing();
+        testAlertGeneration();
+        testPriorityScheduling();
+        testFalseAlarmDetection();
+        testMonitorClock();
+        testEventDrivenSimulation();
+        testAlertEscalation();
+        testAlertAcknowledgement();
+        testAlertCoalescing();
+        testDeviceRandomStreams();
+        testCorrelatedVitalSignals();
+        testTraceRecordReplay();
+        testBatchProcessing();
+        testPatientIndex();
+        testDeviceTable();
+        testDeviceLifecycle();
+        testDischargeAndTransfer();
+        testCensusAdmission();
+        testRiskIndex();
+        testEarlyWarningScore();
+        testAdaptiveBaseline();
+        testQuantileSketches();
+        testArtifactDetectors();
+        testAlarmConfirmation();
+        testAlertDispatcher();
+        testDispatchLanes();
+        testPatientLocking();
+        testSnapshotReads();
+#ifdef ASYNC_NOTIFICATIONS
+        testAsyncNotifications();
+#endif
+        
+        std::cout << "✓ All tests passed!" << std::endl;
+    }
+    
+private:
+    static void testPatientCreation() {
+        Patient patient(1, "Test Patient", 30);
+        assert(patient.getId() == 1);
+        assert(patient.getName() == "Test Patient");
+        std::cout << "✓ Patient creation test passed" << std::endl;
+    }
+    
+    static void testVitalReadingProcessing() {
+        Patient patient(1, "Test", 30);
+        VitalReading reading(VitalSign::HEART_RATE, 200.0, 1);
+        Priority risk = patient.assessRisk(reading);
+        assert(risk == Priority::CRITICAL);
+        std::cout << "✓ Vital reading processing test passed" << std::endl;
+    }
+    
+    static void testAlertGeneration() {
+        Alert alert(1, Priority::CRITICAL, "Test alert", VitalSign::HEART_RATE);
+        assert(alert.priority == Priority::CRITICAL);
+        assert(alert.patientId == 1);
+        std::cout << "✓ Alert generation test passed" << std::endl;
+    }
+    
+    static void testPriorityScheduling() {
+        // Test alert comparator
+        auto alert1 = std::make_shared<Alert>(1, Priority::HIGH, "Test", VitalSign::HEART_RATE);
+        auto alert2 = std::make_shared<Alert>(2, Priority::CRITICAL, "Test", VitalSign::HEART_RATE);
+        
+        AlertComparator comp;
+        assert(comp(alert1, alert2)); // Critical should have higher priority
+        std::cout << "✓ Priority scheduling test passed" << std::endl;
+    }
+    
+    static void testFalseAlarmDetection() {
+        std::vector<VitalReading> readings;
+        for (int i = 0; i < 10; ++i) {
+            readings.emplace_back(VitalSign::HEART_RATE, 75.0 + i, 1);
+        }
+        
+        Alert alert(1, Priority::MEDIUM, "Test", VitalSign::HEART_RATE);
+        bool isFalse = FalseAlarmDetector::isLikelyFalseAlarm(alert, readings);
+        assert(!isFalse);   // 84 is ~1.9 sigma above the nine readings before it
+        
+        // The judged reading is excluded, so it cannot inflate the spread
+        readings.back().value = 130.0;
+        assert(!FalseAlarmDetector::isLikelyFalseAlarm(alert, readings));
+        readings.back().value = 80.0;
+        assert(FalseAlarmDetector::isLikelyFalseAlarm(alert, readings));
+        
+        std::cout << "✓ False alarm detection test passed" << std::endl;
+    }
+    
+    static void testMonitorClock() {
+        auto realBefore = MonitorClock::now();
+        auto realAfter = MonitorClock::now();
+        assert(realAfter >= realBefore);
+        
+        // Simulated time only moves when advanced, and never backwards
+        MonitorClock::useSimulatedTime(MonitorClock::time_point(std::chrono::hours(1)));
+        auto start = MonitorClock::now();
+        auto wallStart = MonitorClock::toWallClock(start);
+        MonitorClock::advance(std::chrono::seconds(90));
+        MonitorClock::advanceTo(start);
+        auto later = MonitorClock::now();
+        assert(later - start == std::chrono::seconds(90));
+        assert(MonitorClock::toWallClock(later) - wallStart == std::chrono::seconds(90));
+        
+        Alert alert(1, Priority::HIGH, "Test", VitalSign::HEART_RATE);
+        assert(alert.createdAt == later);
+        MonitorClock::useRealTime();
+        
+        std::cout << "✓ Monitor clock test passed" << std::endl;
+    }
+    
+    static void testEventDrivenSimulation() {
+        SampleEventQueue queue(std::chrono::seconds(1), 8);
+        MonitorClock::time_point base(std::chrono::seconds(100));
+        queue.schedule(base + std::chrono::seconds(20), 2); // lands a full "year" later
+        queue.schedule(base + std::chrono::milliseconds(500), 1);
+        queue.schedule(base, 0);
+        std::vector<SampleEventQueue::Event> window;
+        assert(queue.popNextWindow(window) && window.size() == 2);
+        assert(window[0].deviceIndex == 0 && window[1].deviceIndex == 1);
+        assert(queue.popNextWindow(window) && window.size() == 1 && window[0].deviceIndex == 2);
+        assert(!queue.popNextWindow(window));
+        
+        // One virtual hour: per patient 3600 HR + 3600 SpO2 + 4 NIBP + 12 temperature + 3600 RR
+        HospitalScheduler scheduler;
+        scheduler.setVerbose(false);
+        scheduler.addPatient(std::make_unique<Patient>(1, "Test A", 40));
+        scheduler.addPatient(std::make_unique<Patient>(2, "Test B", 60));
+        SimulationReport report = scheduler.runEventDrivenSimulation(std::chrono::hours(1));
+        assert(report.readingsGenerated == 2 * (3600 + 3600 + 4 + 12 + 3600));
+        assert(!MonitorClock::isSimulated());
+        
+        std::cout << "✓ Event-driven simulation test passed" << std::endl;
+    }
+    
+    static void testAlertEscalation() {
+        MonitorClock::useSimulatedTime(MonitorClock::time_point(std::chrono::hours(10)));
+        auto start = MonitorClock::now();
+        
+        // Timing wheel: cancelled timers never fire, long timers cascade down
+        TimingWheel wheel;
+        std::vector<std::uint64_t> fired;
+        auto record = [&fired](std::uint64_t payload) { fired.push_back(payload); };
+        wheel.schedule(start + std::chrono::seconds(2), 1);
+        auto cancelled = wheel.schedule(start + std::chrono::seconds(1), 2);
+        wheel.schedule(start + std::chrono::seconds(3600), 3);
+        assert(wheel.cancel(cancelled));
+        assert(!wheel.cancel(cancelled));
+        wheel.advanceTo(start + std::chrono::seconds(3599), record);
+        assert(fired.size() == 1 && fired[0] == 1);
+        wheel.advanceTo(start + std::chrono::seconds(3600), record);
+        assert(fired.size() == 2 && fired[1] == 3 && wheel.size() == 0);
+        
+        // Unacknowledged HIGH alert escalates to CRITICAL after 30s
+        AlertProcessor processor;
+        processor.setVerbose(false);
+        auto alert = std::make_shared<Alert>(1, Priority::HIGH, "Test", VitalSign::HEART_RATE);
+        processor.addAlert(alert);
+        processor.processAllAlerts();
+        MonitorClock::advance(std::chrono::seconds(31));
+        processor.processAllAlerts();
+        assert(processor.getTotalEscalations() == 1);
+        assert(processor.getTotalAlertsProcessed() == 2);
+        
+        // Acknowledging cancels the CRITICAL re-notification timer
+        assert(processor.acknowledgeAlert(alert->alertId));
+        MonitorClock::advance(std::chrono::seconds(10));
+        processor.processAllAlerts();
+        assert(processor.getTotalEscalations() == 1);
+        assert(processor.getUnacknowledgedCount() == 0);
+        
+        // Once escalations run out the alert stays open, flagged expired and
+        // acknowledgeable, and is no longer re-raised
+        auto ignored = std::make_shared<Alert>(2, Priority::CRITICAL, "Ignored", VitalSign::HEART_RATE);
+        processor.addAlert(ignored);
+        for (int i = 0; i < 10; ++i) {
+            MonitorClock::advance(std::chrono::seconds(3));
+            processor.processAllAlerts();
+        }
+        assert(processor.getTotalEscalations() == 4 && processor.getExpiredUnacknowledged() == 1);
+        auto open = processor.getOpenAlerts(2);
+        assert(open.size() == 1 && open[0]->expired && open[0]->alertId == ignored->alertId);
+        assert(processor.getUnacknowledgedCount() == 1);
+        assert(processor.acknowledgeAlert(ignored->alertId));
+        assert(processor.getOpenAlerts(2).empty() && processor.getUnacknowledgedCount() == 0);
+        MonitorClock::useRealTime();
+        
+        std::cout << "✓ Alert escalation test passed" << std::endl;
+    }
+    
+    static void testAlertAcknowledgement() {
+        AlertProcessor processor;
+        processor.setVerbose(false);
+        
+        std::vector<std::shared_ptr<Alert>> alerts;
+        for (int i = 0; i < 200; ++i) {
+            alerts.push_back(std::make_shared<Alert>(1 + (i % 4), Priority::MEDIUM, "Test", VitalSign::HEART_RATE));
+            processor.addAlert(alerts.back());
+        }
+        assert(processor.getUnacknowledgedCount() == 200);
+        assert(processor.getOpenAlerts(1).size() == 50);
+        
+        // Acknowledge patient 2's alerts by id from another thread while dispatching
+        std::thread acker([&processor, &alerts]() {
+            for (size_t i = 1; i < alerts.size(); i += 4) {
+                assert(processor.acknowledgeAlert(alerts[i]->alertId));
+            }
+        });
+        processor.processAllAlerts();
+        acker.join();
+        
+        assert(processor.getOpenAlerts(2).empty());
+        assert(!processor.acknowledgeAlert(alerts[1]->alertId));
+        assert(processor.acknowledgePatientAlerts(3) == 50);
+        assert(processor.getUnacknowledgedCount() == 100);
+        assert(alerts[2]->acknowledged && !alerts[0]->acknowledged);
+        
+        std::cout << "✓ Alert acknowledgement test passed" << std::endl;
+    }
+    
+    static void testAlertCoalescing() {
+        MonitorClock::useSimulatedTime(MonitorClock::time_point(std::chrono::hours(20)));
+        HospitalScheduler scheduler;
+        scheduler.setVerbose(false);
+        scheduler.addPatient(std::make_unique<Patient>(1, "Test", 50));
+        scheduler.setConfirmationPolicy(ConfirmationPolicy::immediate());
+        
+        // Per-vital alerts only; HR 134 also opens a NEWS2 score alert
+        auto vitalAlerts = [&scheduler]() {
+            auto open = scheduler.getOpenAlerts(1);
+            open.erase(std::remove_if(open.begin(), open.end(), [](const std::shared_ptr<Alert>& alert) {
+                return alert->kind == AlertKind::SCORE;
+            }), open.end());
+            return open;
+        };
+        
+        // A bed sitting at HR 130 raises one HIGH alert, not one per sample
+        for (int i = 0; i < 50; ++i) {
+            double value = (i == 49) ? 134.0 : 130.0;
+            scheduler.processVitalReading(VitalReading(VitalSign::HEART_RATE, value, 1));
+            MonitorClock::advance(std::chrono::seconds(1));
+        }
+        auto open = vitalAlerts();
+        assert(open.size() == 1);
+        assert(open[0]->occurrenceCount == 50 && open[0]->worstValue == 134.0);
+        assert(scheduler.getAlertsCoalesced() == 49);
+        
+        // After a quiet window the next episode opens a fresh alert
+        MonitorClock::advance(std::chrono::minutes(2));
+        scheduler.processVitalReading(VitalReading(VitalSign::HEART_RATE, 134.0, 1));
+        assert(vitalAlerts().size() == 2);
+        
+        // Acknowledged alerts stop absorbing repeats
+        scheduler.acknowledgePatientAlerts(1);
+        scheduler.processVitalReading(VitalReading(VitalSign::HEART_RATE, 138.0, 1));
+        assert(vitalAlerts().size() == 1);
+        MonitorClock::useRealTime();
+        
+        std::cout << "✓ Alert coalescing test passed" << std::endl;
+    }
+    
+    static void testDeviceRandomStreams() {
+        // Same seed and device id reproduce the stream; batch matches single calls
+        std::uint64_t savedSeed = MedicalDevice::getSimulationSeed();
+        MedicalDevice::setSimulationSeed(42);
+        MonitorClock::useSimulatedTime(MonitorClock::time_point(std::chrono::hours(30)));
+        MedicalDevice first(7, VitalSign::HEART_RATE, 1);
+        MedicalDevice second(7, VitalSign::HEART_RATE, 1);
+        MedicalDevice other(8, VitalSign::HEART_RATE, 1);
+        
+        std::vector<VitalReading> batch;
+        second.generateReadings(100, batch);
+        assert(batch.size() == 100);
+        
+        bool differs = false;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            double value = first.generateReading().value;
+            assert(value == batch[i].value);
+            assert(value >= 20.0 && value <= 250.0);
+            differs = differs || (other.generateReading().value != value);
+            MonitorClock::advance(first.getSamplingInterval());
+        }
+        assert(differs);
+        assert(batch[1].timestamp - batch[0].timestamp == second.getSamplingInterval());
+        MedicalDevice::setSimulationSeed(savedSeed);
+        MonitorClock::useRealTime();
+        
+        std::cout << "✓ Device random stream test passed" << std::endl;
+    }
+    
+    static void testCorrelatedVitalSignals() {
+        MonitorClock::useSimulatedTime(MonitorClock::time_point(std::chrono::hours(40)));
+        auto start = MonitorClock::now();
+        
+        // A stable patient stays within physiological bounds all day
+        auto physiology = std::make_shared<PatientPhysiology>(3);
+        MedicalDevice spo2(1, VitalSign::OXYGEN_SATURATION, 3, physiology);
+        MedicalDevice temperature(2, VitalSign::TEMPERATURE, 3, physiology);
+        std::vector<VitalReading> readings;
+        spo2.generateReadings(24 * 3600, readings);
+        temperature.generateReadings(24 * 12, readings);
+        for (const auto& reading : readings) {
+            if (reading.type == VitalSign::OXYGEN_SATURATION) {
+                assert(reading.value >= 50.0 && reading.value <= 100.0);
+            } else {
+                assert(reading.value >= 30.0 && reading.value <= 43.0);
+            }
+        }
+        
+        // Respiratory failure pulls SpO2 down and HR/RR up together
+        auto failing = std::make_shared<PatientPhysiology>(4);
+        double spo2Before = failing->meanAt(VitalSign::OXYGEN_SATURATION, start);
+        double hrBefore = failing->meanAt(VitalSign::HEART_RATE, start);
+        double rrBefore = failing->meanAt(VitalSign::RESPIRATORY_RATE, start);
+        failing->scheduleDeterioration(DeteriorationProfile::RESPIRATORY_FAILURE, start, std::chrono::hours(1));
+        auto later = start + std::chrono::hours(2);
+        assert(failing->meanAt(VitalSign::OXYGEN_SATURATION, later) < spo2Before - 10.0);
+        assert(failing->meanAt(VitalSign::HEART_RATE, later) > hrBefore + 10.0);
+        assert(failing->meanAt(VitalSign::RESPIRATORY_RATE, later) > rrBefore + 10.0);
+        
+        // Latent state depends only on seed and time since the origin: a
+        // device generating a day ahead changes nothing another device sees,
+        // and desaturation episodes still move SpO2 and HR together
+        auto shared = std::make_shared<PatientPhysiology>(5, 7);
+        PatientPhysiology fresh(5, 7);
+        MedicalDevice ahead(3, VitalSign::OXYGEN_SATURATION, 5, shared);
+        std::vector<VitalReading> day;
+        ahead.generateReadings(24 * 3600, day);
+        double restingSpo2 = fresh.meanAt(VitalSign::OXYGEN_SATURATION, start);
+        bool desaturated = false;
+        for (int step = 0; step < 3 * 24 * 120; ++step) {
+            auto t = start + std::chrono::seconds(30 * step);
+            assert(shared->meanAt(VitalSign::HEART_RATE, t) == fresh.meanAt(VitalSign::HEART_RATE, t));
+            desaturated |= fresh.meanAt(VitalSign::OXYGEN_SATURATION, t) < restingSpo2 - 3.0 &&
+                           fresh.meanAt(VitalSign::HEART_RATE, t) > fresh.meanAt(VitalSign::HEART_RATE, start) + 3.0;
+        }
+        assert(desaturated);
+        assert(PatientPhysiology(5, 8).meanAt(VitalSign::HEART_RATE, start) != fresh.meanAt(VitalSign::HEART_RATE, start));
+        MonitorClock::useRealTime();
+        
+        std::cout << "✓ Correlated vital signal test passed" << std::endl;
+    }
+    
+    static void testTraceRecordReplay() {
+        const std::string path = (std::filesystem::temp_directory_path() /
+            ("hpm_selftest_trace_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".bin")).string();
+        long recorded = 0;
+        std::ostringstream recordedLog;
+        {
+            // The trace starts at the first admission; the live run's alert
+            // log uses the same epoch as a replay's
+            auto start = MonitorClock::time_point(std::chrono::hours(50));
+            MonitorClock::useSimulatedTime(start);
+            HospitalScheduler scheduler;
+            scheduler.setVerbose(false);
+            scheduler.setAlertLog(&recordedLog, start);
+            assert(scheduler.startRecording(path));
+            scheduler.addPatient(std::make_unique<Patient>(1, "Test A", 40));
+            scheduler.addPatient(std::make_unique<Patient>(2, "Test B", 70));
+            scheduler.scheduleDeterioration(2, DeteriorationProfile::SEPSIS, std::chrono::minutes(5), std::chrono::minutes(10));
+            scheduler.runEventDrivenSimulation(std::chrono::minutes(30));
+            recorded = scheduler.stopRecording();
+            scheduler.setAlertLog(nullptr, MonitorClock::time_point());
+            MonitorClock::useRealTime();
+        }
+        
+        // Two replays of the same trace produce identical alert logs
+        std::ostringstream firstLog, secondLog;
+        TraceReplayer::ReplayReport firstReport, secondReport;
+        HospitalScheduler first, second;
+        first.setVerbose(false);
+        second.setVerbose(false);
+        assert(TraceReplayer::replay(first, path, 0.0, &firstLog, firstReport));
+        assert(TraceReplayer::replay(second, path, 0.0, &secondLog, secondReport));
+        
+        assert(firstReport.readingsReplayed == recorded && recorded > 0);
+        assert(firstReport.patientsAdmitted == 2);
+        assert(!firstLog.str().empty());
+        assert(firstLog.str() == secondLog.str());
+        assert(!MonitorClock::isSimulated());
+        
+        // ...and the same log as the live run that recorded the trace, so a
+        // trace is a diffable regression case
+        assert(firstLog.str() == recordedLog.str());
+        
+        // With dispatch workers the alert log is written on the background
+        // lane and still matches
+        {
+            std::ostringstream pooledLog;
+            TraceReplayer::ReplayReport pooledReport;
+            HospitalScheduler pooled;
+            pooled.setVerbose(false);
+            pooled.setDispatchWorkers(2);
+            assert(TraceReplayer::replay(pooled, path, 0.0, &pooledLog, pooledReport));
+            assert(pooledLog.str() == firstLog.str());
+            pooled.setDispatchWorkers(0);
+        }
+        
+        // Trace chunks go to the background runner; drains run in any order
+        // and late drains after close are harmless, yet the file keeps
+        // record order
+        {
+            std::vector<std::function<void()>> drains;
+            {
+                ReadingTraceWriter writer(path, [&drains](std::function<void()> task) { drains.push_back(std::move(task)); });
+                for (int i = 0; i < 20000; ++i) {
+                    writer.writeReading(VitalReading(VitalSign::HEART_RATE, 60.0 + i % 50, 1 + i % 7));
+                    if (i == 12000) {
+                        for (auto it = drains.rbegin(); it != drains.rend(); ++it) (*it)();
+                    }
+                }
+            }
+            assert(drains.size() >= 3);
+            for (auto& drain : drains) drain();
+            ReadingTraceReader reader(path);
+            ReadingTraceReader::Record record;
+            int count = 0;
+            bool ordered = true;
+            while (reader.next(record)) {
+                ordered = ordered && record.reading.patientId == 1 + count % 7 && record.reading.value == 60.0 + count % 50;
+                count++;
+            }
+            assert(count == 20000 && ordered && !reader.isCorrupt());
+        }
+        
+        // Unknown record kinds and out-of-range vitals are rejected, not
+        // cast into table indexes
+        for (int corruption = 0; corruption < 2; ++corruption) {
+            {
+                ReadingTraceWriter writer(path);
+                writer.writeAdmission(1, 40);
+                writer.writeReading(VitalReading(VitalSign::HEART_RATE, 80.0, 1));
+                writer.writeReading(VitalReading(corruption == 0 ? static_cast<VitalSign>(VITAL_SIGN_COUNT) : VitalSign::HEART_RATE, 80.0, 1));
+            }
+            if (corruption == 1) {
+                std::ofstream(path, std::ios::binary | std::ios::app).put(static_cast<char>(7));
+            }
+            HospitalScheduler scheduler;
+            scheduler.setVerbose(false);
+            TraceReplayer::ReplayReport report;
+            assert(!TraceReplayer::replay(scheduler, path, 0.0, nullptr, report));
+            assert(report.readingsReplayed == 1 + corruption && !MonitorClock::isSimulated());
+        }
+        std::remove(path.c_str());
+        assert(!std::filesystem::exists(path));
+        
+        std::cout << "✓ Trace record/replay test passed" << std::endl;
+    }
+    
+    static void testBatchProcessing() {
+        // Batch classification agrees with per-reading assessRisk
+        Patient patient(1, "Test", 50);
+        for (size_t v = 0; v < VITAL_SIGN_COUNT; ++v) {
+            VitalSign vital = static_cast<VitalSign>(v);
+            std::vector<double> values;
+            for (double x = 0.0; x <= 250.0; x += 0.5) values.push_back(x);
+            std::vector<Priority> risks(values.size());
+            Patient::classifyRisk(vital, values.data(), values.size(), patient.getNormalRange(vital), risks.data());
+            for (size_t i = 0; i < values.size(); ++i) {
+                assert(risks[i] == patient.assessRisk(VitalReading(vital, values[i], 1)));
+            }
+        }
+        
+        // A frame produces the same open alerts as feeding readings one by one
+        MonitorClock::useSimulatedTime(MonitorClock::time_point(std::chrono::hours(50)));
+        auto t0 = MonitorClock::now();
+        std::vector<VitalReading> frame;
+        for (int i = 0; i < 20; ++i) {
+            auto t = t0 + std::chrono::seconds(i);
+            frame.emplace_back(VitalSign::HEART_RATE, 130.0, 1, t);
+            frame.emplace_back(VitalSign::OXYGEN_SATURATION, 80.0, 2, t);
+            frame.emplace_back(VitalSign::HEART_RATE, 75.0, 2, t);
+            frame.emplace_back(VitalSign::HEART_RATE, 75.0, 99, t); // not admitted
+        }
+        HospitalScheduler single, batched;
+        for (HospitalScheduler* scheduler : {&single, &batched}) {
+            scheduler->setVerbose(false);
+            scheduler->addPatient(std::make_unique<Patient>(1, "Test A", 40), false);
+            scheduler->addPatient(std::make_unique<Patient>(2, "Test B", 60), false);
+        }
+        for (const auto& reading : frame) single.processVitalReading(reading);
+        batched.processBatch(frame);
+        
+        // Patient 2 also crosses into a NEWS2 band (SpO2 80 scores 3)
+        auto byMessage = [](const std::shared_ptr<Alert>& a, const std::shared_ptr<Alert>& b) {
+            return a->message < b->message;
+        };
+        for (int pid = 1; pid <= 2; ++pid) {
+            auto expected = single.getOpenAlerts(pid);
+            auto actual = batched.getOpenAlerts(pid);
+            assert(expected.size() == static_cast<size_t>(pid) && actual.size() == expected.size());
+            std::sort(expected.begin(), expected.end(), byMessage);
+            std::sort(actual.begin(), actual.end(), byMessage);
+            for (size_t i = 0; i < expected.size(); ++i) {
+                assert(actual[i]->priority == expected[i]->priority && actual[i]->message == expected[i]->message);
+                assert(actual[i]->occurrenceCount == expected[i]->occurrenceCount);
+                // HR 130 (HIGH) waits one sample for 2-of-3 confirmation; CRITICAL SpO2 does not
+                int samples = expected[i]->priority == Priority::CRITICAL ? 20 : 19;
+                assert(expected[i]->message.find("NEWS2") == 0 || expected[i]->occurrenceCount == samples);
+            }
+        }
+        assert(batched.getAlertsCoalesced() == single.getAlertsCoalesced());
+        
+        // A baseline that warms and widens partway through a group applies
+        // to the rest of that group, as it does reading by reading
+        std::vector<VitalReading> drift;
+        for (int i = 0; i < 600; ++i) {
+            double value = 96.0 + (i % 9) + (i >= 300 ? 3.0 : 0.0);
+            drift.emplace_back(VitalSign::HEART_RATE, value, 3, t0 + std::chrono::seconds(i));
+        }
+        HospitalScheduler driftSingle, driftBatched;
+        for (HospitalScheduler* scheduler : {&driftSingle, &driftBatched}) {
+            scheduler->setVerbose(false);
+            scheduler->addPatient(std::make_unique<Patient>(3, "Test C", 50), false);
+        }
+        for (const auto& reading : drift) driftSingle.processVitalReading(reading);
+        driftBatched.processBatch(drift);
+        assert(driftSingle.getAlertsPending() > 0);
+        assert(driftBatched.getAlertsPending() == driftSingle.getAlertsPending());
+        assert(driftBatched.getAlertsCoalesced() == driftSingle.getAlertsCoalesced());
+        assert(driftBatched.getOpenAlerts(3).size() == driftSingle.getOpenAlerts(3).size());
+        MonitorClock::useRealTime();
+        
+        std::cout << "✓ Batch processing test passed" << std::endl;
+    }
+    
+    static void testPatientIndex() {
+        StableArena<Patient> arena;
+        PatientIndex index;
+        std::vector<Patient*> addresses;
+        for (int i = 0; i < 5000; ++i) {
+            int id = i * 7919 - 100000; // sparse, includes negatives
+            std::uint32_t slot = arena.emplace(id, "P", 50);
+            index.insert(id, slot);
+            addresses.push_back(arena.get(slot));
+        }
+        
+        // Addresses survive growth; half the ids are removed, slots reused
+        for (int i = 0; i < 5000; ++i) {
+            int id = i * 7919 - 100000;
+            std::uint32_t slot = index.find(id);
+            assert(slot != PatientIndex::NONE && arena.get(slot) == addresses[i]);
+            assert(addresses[i]->getId() == id);
+            if (i % 2 == 0) {
+                arena.erase(slot);
+                assert(index.erase(id));
+            }
+        }
+        for (int i = 0; i < 5000; ++i) {
+            int id = i * 7919 - 100000;
+            assert((index.find(id) == PatientIndex::NONE) == (i % 2 == 0));
+        }
+        assert(index.size() == 2500 && arena.size() == 2500);
+        std::uint32_t reused = arena.emplace(42, "Reused", 30);
+        assert(arena.get(reused) == addresses[4998]);
+        
+        std::cout << "✓ Patient index test passed" << std::endl;
+    }
+    
+    static void testDeviceTable() {
+        // Table rows reproduce the matching MedicalDevice stream; polling
+        // skips inactive rows and stays grouped by vital type
+        std::uint64_t savedSeed = MedicalDevice::getSimulationSeed();
+        MedicalDevice::setSimulationSeed(99);
+        MonitorClock::useSimulatedTime(MonitorClock::time_point(std::chrono::hours(12)));
+        
+        DeviceTable table;
+        std::vector<DeviceTable::DeviceId> heartRate;
+        for (int pid = 0; pid < 200; ++pid) {
+            auto physiology = std::make_shared<PatientPhysiology>(pid);
+            heartRate.push_back(table.attach(VitalSign::HEART_RATE, pid, physiology));
+            table.attach(VitalSign::OXYGEN_SATURATION, pid, physiology);
+        }
+        assert(table.size() == 400 && table.getActiveCount() == 400);
+        assert(heartRate[3] == 6 && table.getPatientId(heartRate[3]) == 3);
+        
+        MedicalDevice reference(6, VitalSign::HEART_RATE, 3, std::make_shared<PatientPhysiology>(3));
+        for (int i = 0; i < 20; ++i) {
+            auto now = MonitorClock::now();
+            assert(table.generate(heartRate[3], now).value == reference.generateReading().value);
+            MonitorClock::advance(std::chrono::seconds(1));
+        }
+        
+        for (int pid = 0; pid < 200; pid += 3) {
+            table.setActive(heartRate[pid], false);
+        }
+        std::vector<VitalReading> out;
+        table.poll(VitalSign::HEART_RATE, MonitorClock::now(), out);
+        assert(out.size() == 200 - 67 && table.getActiveCount() == 400 - 67);
+        for (const auto& reading : out) {
+            assert(reading.type == VitalSign::HEART_RATE && reading.patientId % 3 != 0);
+        }
+        
+        MedicalDevice::setSimulationSeed(savedSeed);
+        MonitorClock::useRealTime();
+        std::cout << "✓ Device table test passed" << std::endl;
+    }
+    
+    static void testDeviceLifecycle() {
+        // Detached ids go stale, slots are reused under a new generation,
+        // and polling only sees attached, active devices
+        DeviceTable table;
+        auto physiology = std::make_shared<PatientPhysiology>(1);
+        std::vector<DeviceTable::DeviceId> ids;
+        for (int i = 0; i < 100; ++i) {
+            ids.push_back(table.attach(VitalSign::HEART_RATE, i, physiology));
+        }
+        for (int i = 0; i < 100; i += 2) {
+            assert(table.detach(ids[i]));
+        }
+        assert(!table.detach(ids[0]) && !table.contains(ids[0]) && table.size() == 50);
+        for (int i = 1; i < 100; i += 2) {
+            assert(table.contains(ids[i]) && table.getPatientId(ids[i]) == i);
+        }
+        
+        DeviceTable::DeviceId reused = table.attach(VitalSign::HEART_RATE, 500, physiology);
+        assert(reused != ids[98] && (reused & ((1 << DeviceTable::SLOT_BITS) - 1)) == ids[98]);
+        assert(!table.contains(ids[98]) && table.getPatientId(reused) == 500);
+        assert(table.reassign(reused, 501, physiology) && table.getPatientId(reused) == 501);
+        
+        std::vector<VitalReading> out;
+        table.poll(VitalSign::HEART_RATE, MonitorClock::now(), out);
+        assert(out.size() == 51 && table.getActiveCount() == 51);
+        
+        // Scheduler attaches all five vitals, including respiratory rate
+        HospitalScheduler scheduler;
+        scheduler.addPatient(std::make_unique<Patient>(1, "Bed One", 60));
+        scheduler.addPatient(std::make_unique<Patient>(2, "Bed Two", 70));
+        auto bedOne = scheduler.getPatientDevices(1);
+        assert(bedOne.size() == VITAL_SIGN_COUNT);
+        assert(scheduler.detachDevice(bedOne[0]) && !scheduler.detachDevice(bedOne[0]));
+        assert(scheduler.reassignDevice(bedOne[1], 2));
+        assert(scheduler.getPatientDevices(1).size() == 3 && scheduler.getPatientDevices(2).size() == 6);
+        DeviceTable::DeviceId extra = scheduler.attachDevice(1, VitalSign::RESPIRATORY_RATE);
+        assert(extra != DeviceTable::INVALID_ID && scheduler.attachDevice(99, VitalSign::HEART_RATE) == DeviceTable::INVALID_ID);
+        assert(scheduler.detachPatientDevices(1) == 4 && scheduler.getPatientDevices(1).empty());
+        
+        // Pause, resume and attach take effect within an event-driven run:
+        // on the first alert a handler resumes one of bed three's monitors
+        // and attaches another, and both sample for the rest of the run
+        {
+            MonitorClock::useSimulatedTime(MonitorClock::time_point(std::chrono::hours(60)));
+            HospitalScheduler unit;
+            unit.setVerbose(false);
+            unit.addPatient(std::make_unique<Patient>(3, "Bed Three", 50));
+            unit.addPatient(std::make_unique<Patient>(4, "Bed Four", 70));
+            unit.scheduleDeterioration(4, DeteriorationProfile::SEPSIS, std::chrono::minutes(5), std::chrono::minutes(10));
+            // Devices are attached in VitalSign order
+            auto bedThree = unit.getPatientDevices(3);
+            DeviceTable::DeviceId paused = bedThree[static_cast<size_t>(VitalSign::HEART_RATE)];
+            DeviceTable::DeviceId removed = bedThree[static_cast<size_t>(VitalSign::OXYGEN_SATURATION)];
+            assert(unit.setDeviceActive(paused, false) && unit.detachDevice(removed));
+            bool changed = false;
+            MonitorClock::time_point changedAt;
+            unit.setAlertHandler([&](const Alert&) {
+                if (changed) return;
+                changed = true;
+                changedAt = MonitorClock::now();
+                unit.setDeviceActive(paused, true);
+                unit.attachDevice(3, VitalSign::OXYGEN_SATURATION);
+            });
+            unit.runEventDrivenSimulation(std::chrono::minutes(30));
+            assert(changed);
+            auto heart = unit.getRecentReadings(3, VitalSign::HEART_RATE, 1);
+            auto oxygen = unit.getRecentReadings(3, VitalSign::OXYGEN_SATURATION, 1);
+            assert(heart.size() == 1 && heart[0].timestamp > changedAt);
+            assert(oxygen.size() == 1 && oxygen[0].timestamp > changedAt);
+            MonitorClock::useRealTime();
+        }
+        
+        std::cout << "✓ Device lifecycle test passed" << std::endl;
+    }
+    
+    static void testDischargeAndTransfer() {
+        MonitorClock::useSimulatedTime(MonitorClock::time_point(std::chrono::hours(40)));
+        HospitalScheduler icu;
+        HospitalScheduler ward;
+        icu.setVerbose(false);
+        ward.setVerbose(false);
+        
+        // History is a fixed ring per vital: the last 100 readings survive
+        Patient standalone(1, "Ring", 40);
+        for (int i = 0; i < 250; ++i) {
+            standalone.addVitalReading(VitalReading(VitalSign::TEMPERATURE, 30.0 + i * 0.01, 1));
+        }
+        auto ring = standalone.getRecentReadings(VitalSign::TEMPERATURE, 200);
+        assert(ring.size() == HistorySlab::HISTORY_CAPACITY);
+        assert(ring.front().value == 30.0 + 150 * 0.01 && ring.back().value == 30.0 + 249 * 0.01);
+        
+        // Turning over beds reuses slabs instead of growing the pool
+        HistorySlabPool& pool = HistorySlabPool::instance();
+        int handled = 0;
+        icu.setAlertHandler([&handled](const Alert&) { handled++; });
+        for (int round = 0; round < 3; ++round) {
+            for (int id = 1; id <= 64; ++id) {
+                icu.addPatient(std::make_unique<Patient>(id, "Bed", 50));
+            }
+            if (round == 0) {
+                icu.processVitalReading(VitalReading(VitalSign::HEART_RATE, 190.0, 5));
+                assert(!icu.getOpenAlerts(5).empty());
+            }
+            auto open = icu.getOpenAlerts(5);
+            size_t capacity = pool.getCapacity();
+            for (int id = 1; id <= 64; ++id) {
+                assert(icu.dischargePatient(id));
+            }
+            assert(pool.getCapacity() == capacity);
+            
+            // Discharge closes open alerts without acknowledging them and
+            // drops their undelivered notifications
+            icu.processPendingAlerts();
+            assert(handled == 0);
+            for (const auto& alert : open) {
+                assert(alert->closed && !alert->acknowledged);
+            }
+        }
+        assert(icu.getPatientCount() == 0 && !icu.dischargePatient(1));
+        assert(icu.getOpenAlerts(5).empty() && icu.getPatientDevices(5).empty());
+        
+        // Transfer carries the history to the destination unit
+        icu.addPatient(std::make_unique<Patient>(7, "Transfer", 65));
+        for (int i = 0; i < 10; ++i) {
+            icu.processVitalReading(VitalReading(VitalSign::HEART_RATE, 80.0 + i, 7));
+        }
+        assert(icu.transferPatient(7, ward) && !icu.transferPatient(7, ward));
+        assert(icu.getPatientCount() == 0 && ward.getPatientCount() == 1);
+        assert(icu.getPatientDevices(7).empty() && ward.getPatientDevices(7).size() == VITAL_SIGN_COUNT);
+        ward.processVitalReading(VitalReading(VitalSign::HEART_RATE, 90.0, 7));
+        assert(ward.getOpenAlerts(7).empty());
+        
+        // Re-admitting an id releases the old record like a discharge: its
+        // open alerts are closed and its devices detached, even when the new
+        // record comes without devices (as in replays)
+        icu.addPatient(std::make_unique<Patient>(9, "First stay", 60));
+        icu.processVitalReading(VitalReading(VitalSign::HEART_RATE, 190.0, 9));
+        auto firstStay = icu.getOpenAlerts(9);
+        assert(!firstStay.empty() && icu.getPatientDevices(9).size() == VITAL_SIGN_COUNT);
+        icu.addPatient(std::make_unique<Patient>(9, "Second stay", 61), false);
+        for (const auto& alert : firstStay) {
+            assert(alert->closed && !alert->acknowledged);
+        }
+        assert(icu.getOpenAlerts(9).empty());
+        assert(icu.getPatientDevices(9).empty() && icu.getPatientCount() == 1);
+        MonitorClock::useRealTime();
+        
+        std::cout << "✓ Discharge and transfer test passed" << std::endl;
+    }
+    
+    static void testCensusAdmission() {
+        std::stringstream file("# ward census\n1001,Ada Byron,36\r\n\n1002,Alan Turing,41\n");
+        std::vector<CensusEntry> census;
+        std::string error;
+        assert(Census::parse(file, census, error) && census.size() == 2);
+        assert(census[1].id == 1002 && census[1].name == "Alan Turing" && census[1].age == 41);
+        
+        std::stringstream bad("7,Missing Age\n");
+        assert(!Census::parse(bad, census, error) && error.find("line 1") == 0);
+        std::stringstream repeated("5,A,30\n6,B,31\n5,C,32\n");
+        assert(!Census::parse(repeated, census, error) && error == "line 3: duplicate id 5");
+        std::stringstream nonPositive("0,Zero,30\n");
+        assert(!Census::parse(nonPositive, census, error) && error.find("line 1") == 0);
+        
+        // Only new, valid ids count as admissions
+        HospitalScheduler small;
+        small.setVerbose(false);
+        std::vector<int> skipped;
+        std::vector<CensusEntry> mixed = {{1, "A", 30}, {-4, "B", 40}, {1, "C", 50}, {0, "D", 60}, {2, "E", 70}};
+        assert(small.admitCensus(mixed, &skipped) == 2 && small.getPatientCount() == 2);
+        assert((skipped == std::vector<int>{-4, 1, 0}));
+        assert(small.admitCensus(Census::generate(3)) == 1 && small.getPatientCount() == 3);
+        
+        // Thousands of beds, arbitrary ids, top-K without touching the UI
+        HospitalScheduler scheduler;
+        scheduler.setVerbose(false);
+        assert(scheduler.admitCensus(Census::generate(5000, 20000)) == 5000);
+        assert(scheduler.hasPatient(20000) && scheduler.hasPatient(24999) && !scheduler.hasPatient(10));
+        scheduler.processVitalReading(VitalReading(VitalSign::OXYGEN_SATURATION, 70.0, 23456));
+        scheduler.processVitalReading(VitalReading(VitalSign::HEART_RATE, 130.0, 21000));
+        auto top = scheduler.getHighestRiskPatients(3);
+        assert(top.size() == 3 && top[0] == 23456 && top[1] == 21000 && top[2] == 20000);
+        auto risk = scheduler.getRiskCounts();
+        assert(risk[0] == 1 && risk[1] == 1 && risk[3] == 4998);
+        
+        std::cout << "✓ Census admission test passed" << std::endl;
+    }
+    
+    static void testRiskIndex() {
+        MonitorClock::useSimulatedTime(MonitorClock::time_point(std::chrono::hours(50)));
+        HospitalScheduler scheduler;
+        scheduler.setVerbose(false);
+        scheduler.admitCensus(Census::generate(1000));
+        
+        // Buckets follow every reading, both up and back down
+        scheduler.processVitalReading(VitalReading(VitalSign::HEART_RATE, 200.0, 700));
+        scheduler.processVitalReading(VitalReading(VitalSign::OXYGEN_SATURATION, 80.0, 300));
+        scheduler.processVitalReading(VitalReading(VitalSign::TEMPERATURE, 38.7, 42));
+        auto critical = scheduler.getPatientsAtRisk(Priority::CRITICAL);
+        assert(critical.size() == 2 && critical[0] == 700 && critical[1] == 300);
+        auto top = scheduler.getHighestRiskPatients(4);
+        assert(top.size() == 4 && top[2] == 42 && top[3] == 1);
+        
+        scheduler.processVitalReading(VitalReading(VitalSign::HEART_RATE, 80.0, 700));
+        assert(scheduler.getPatientsAtRisk(Priority::CRITICAL) == std::vector<int>{300});
+        assert(scheduler.getRiskCounts()[3] == 998);
+        
+        // Worst vital wins: a normal SpO2 does not clear the HR alarm
+        scheduler.processVitalReading(VitalReading(VitalSign::HEART_RATE, 190.0, 5));
+        scheduler.processVitalReading(VitalReading(VitalSign::OXYGEN_SATURATION, 98.0, 5));
+        assert(scheduler.getRiskCounts()[0] == 2);
+        
+        assert(scheduler.dischargePatient(300) && scheduler.dischargePatient(42));
+        assert(scheduler.getPatientsAtRisk(Priority::CRITICAL) == std::vector<int>{5});
+        assert(scheduler.getRiskCounts()[2] == 0 && scheduler.getHighestRiskPatients(2)[1] == 1);
+        MonitorClock::useRealTime();
+        
+        std::cout << "✓ Risk index test passed" << std::endl;
+    }
+    
+    static void testEarlyWarningScore() {
+        assert(EarlyWarningScore::subScore(VitalSign::HEART_RATE, 40.0) == 3);
+        assert(EarlyWarningScore::subScore(VitalSign::HEART_RATE, 75.0) == 0);
+        assert(EarlyWarningScore::subScore(VitalSign::HEART_RATE, 125.0) == 2);
+        assert(EarlyWarningScore::subScore(VitalSign::BLOOD_PRESSURE, 225.0) == 3);
+        assert(EarlyWarningScore::subScore(VitalSign::OXYGEN_SATURATION, 94.0) == 1);
+        assert(EarlyWarningScore::subScore(VitalSign::TEMPERATURE, 39.5) == 2);
+        assert(EarlyWarningScore::subScore(VitalSign::RESPIRATORY_RATE, 22.0) == 2);
+        
+        MonitorClock::useSimulatedTime(MonitorClock::time_point(std::chrono::hours(60)));
+        HospitalScheduler scheduler;
+        scheduler.setVerbose(false);
+        scheduler.admitCensus(Census::generate(20));
+        assert(scheduler.getScoreDistribution()[0] == 20);
+        
+        // Several mildly abnormal vitals add up to a medium band (score 6).
+        // The score takes only normal or confirmed values: RR 22 counts once
+        // its 3-of-5 confirmation is met, not on the first sample.
+        scheduler.processVitalReading(VitalReading(VitalSign::HEART_RATE, 95.0, 9));
+        scheduler.processVitalReading(VitalReading(VitalSign::BLOOD_PRESSURE, 105.0, 9));
+        scheduler.processVitalReading(VitalReading(VitalSign::OXYGEN_SATURATION, 95.0, 9));
+        scheduler.processVitalReading(VitalReading(VitalSign::TEMPERATURE, 38.5, 9));
+        scheduler.processVitalReading(VitalReading(VitalSign::RESPIRATORY_RATE, 22.0, 9));
+        assert(scheduler.getEarlyWarningScore(9) == 4 && scheduler.getScoreAlertsRaised() == 0);
+        scheduler.processVitalReading(VitalReading(VitalSign::RESPIRATORY_RATE, 22.0, 9));
+        scheduler.processVitalReading(VitalReading(VitalSign::RESPIRATORY_RATE, 22.0, 9));
+        assert(scheduler.getEarlyWarningScore(9) == 6 && scheduler.getScoreAlertsRaised() == 1);
+        assert(scheduler.getScoreDistribution()[6] == 1 && scheduler.getScoreDistribution()[0] == 19);
+        assert(scheduler.getPatientsAtRisk(Priority::HIGH) == std::vector<int>{9});
+        
+        // A single unconfirmed HR sample cannot cross into the high band;
+        // once confirmed it raises a CRITICAL score alert
+        scheduler.processVitalReading(VitalReading(VitalSign::HEART_RATE, 115.0, 9));
+        assert(scheduler.getEarlyWarningScore(9) == 6 && scheduler.getScoreAlertsRaised() == 1);
+        scheduler.processVitalReading(VitalReading(VitalSign::HEART_RATE, 115.0, 9));
+        scheduler.processVitalReading(VitalReading(VitalSign::HEART_RATE, 115.0, 9));
+        assert(scheduler.getEarlyWarningScore(9) == 7 && scheduler.getScoreAlertsRaised() == 2);
+        bool criticalScoreAlert = false;
+        for (const auto& alert : scheduler.getOpenAlerts(9)) {
+            criticalScoreAlert = criticalScoreAlert ||
+                (alert->priority == Priority::CRITICAL && alert->kind == AlertKind::SCORE &&
+                 alert->message.find("NEWS2 score 7") == 0);
+        }
+        assert(criticalScoreAlert);
+        
+        // Score alerts carry their own kind in the alert log, and their
+        // coalescing key is patient-level, distinct from any vital's
+        std::ostringstream log;
+        scheduler.setAlertLog(&log, MonitorClock::now());
+        scheduler.processPendingAlerts();
+        scheduler.setAlertLog(nullptr, MonitorClock::time_point());
+        assert(log.str().find(",9,0,2,1,0,1,NEWS2 score 7") != std::string::npos);
+        assert(AlertCoalescer::makeKey(9, Priority::CRITICAL, AlertCoalescer::Kind::SCORE) !=
+               AlertCoalescer::makeKey(9, VitalSign::HEART_RATE, Priority::CRITICAL, AlertCoalescer::Kind::SCORE));
+        
+        // Hovering on the 6/7 boundary does not open new alerts
+        for (int i = 0; i < 5; ++i) {
+            scheduler.processVitalReading(VitalReading(VitalSign::HEART_RATE, 95.0, 9));
+            scheduler.processVitalReading(VitalReading(VitalSign::HEART_RATE, 115.0, 9));
+        }
+        assert(scheduler.getScoreAlertsRaised() == 2);
+        
+        assert(scheduler.dischargePatient(9));
+        assert(scheduler.getScoreDistribution()[7] == 0 && scheduler.getScoreDistribution()[0] == 19);
+        MonitorClock::useRealTime();
+        
+        std::cout << "✓ Early warning score test passed" << std::endl;
     }
     
-    void addPatient(std::unique_ptr<Patient> patient) {
-        int patientId = patient->getId();
-        patients[patientId] = std::move(patient);
+    static void testAdaptiveBaseline() {
+        // Converges on a shifted distribution with bounded state
+        AdaptiveBaseline baseline;
+        Xoshiro256 rng(7);
+        for (int i = 0; i < 5000; ++i) {
+            baseline.update(VitalSign::HEART_RATE, 105.0 + (rng.nextDouble() - 0.5) * 8.0);
+        }
+        assert(baseline.isWarm() && std::abs(baseline.getMedian() - 105.0) < 1.5);
+        assert(baseline.contains(108.0) && !baseline.contains(130.0));
+        
+        // Age shifts the starting range
+        Patient child(1, "Child", 8), elder(2, "Elder", 80);
+        assert(child.getNormalRange(VitalSign::HEART_RATE).second == 120.0);
+        assert(elder.getNormalRange(VitalSign::BLOOD_PRESSURE).second == 150.0);
+        assert(child.assessRisk(VitalReading(VitalSign::HEART_RATE, 110.0, 1)) == Priority::LOW);
+        
+        // A patient who usually runs at the top of their range (HR 96-104)
+        // stops raising MEDIUM alerts there: LOW readings widen the band
+        // gradually, while absolute HIGH/CRITICAL bands are untouched
+        MonitorClock::useSimulatedTime(MonitorClock::time_point(std::chrono::hours(70)));
+        Patient patient(3, "Tachy", 50);
+        assert(patient.assessRisk(VitalReading(VitalSign::HEART_RATE, 106.0, 3)) == Priority::MEDIUM);
+        for (int i = 0; i < 600; ++i) {
+            VitalReading reading(VitalSign::HEART_RATE, 96.0 + (i % 9), 3);
+            patient.addVitalReading(reading);
+            patient.updateBaseline(reading, patient.assessRisk(reading));
+        }
+        assert(patient.assessRisk(VitalReading(VitalSign::HEART_RATE, 106.0, 3)) == Priority::LOW);
+        assert(patient.assessRisk(VitalReading(VitalSign::HEART_RATE, 125.0, 3)) == Priority::HIGH);
         
-        // Create monitoring devices for this patient
-        createDevicesForPatient(patientId);
+        // MEDIUM readings are never learned, however persistent
+        Patient febrile(4, "Febrile", 50);
+        for (int i = 0; i < 600; ++i) {
+            VitalReading reading(VitalSign::TEMPERATURE, 37.8, 4);
+            febrile.updateBaseline(reading, febrile.assessRisk(reading));
+        }
+        assert(!febrile.getBaseline(VitalSign::TEMPERATURE).isWarm());
+        assert(febrile.assessRisk(VitalReading(VitalSign::TEMPERATURE, 37.8, 4)) == Priority::MEDIUM);
+        for (int i = 0; i < 600; ++i) {
+            VitalReading reading(VitalSign::HEART_RATE, 190.0, 3);
+            patient.updateBaseline(reading, patient.assessRisk(reading));
+        }
+        assert(patient.getBaseline(VitalSign::HEART_RATE).getMedian() < 110.0);
+        
+        // The detector treats a MEDIUM value inside the learned band as
+        // usual, but never one outside the absolute MEDIUM band (a fever
+        // above 38.5 C stays an alarm whatever the patient's history)
+        Alert medium(3, Priority::MEDIUM, "Temp", VitalSign::TEMPERATURE);
+        AdaptiveBaseline warm, fever;
+        for (int i = 0; i < 200; ++i) {
+            warm.update(VitalSign::TEMPERATURE, 37.7 + 0.05 * (i % 3));
+            fever.update(VitalSign::TEMPERATURE, 38.6 + 0.05 * (i % 3));
+        }
+        std::vector<VitalReading> recent(1, VitalReading(VitalSign::TEMPERATURE, 37.75, 3));
+        assert(FalseAlarmDetector::isLikelyFalseAlarm(medium, recent, warm));
+        recent[0].value = 38.65;
+        assert(fever.contains(38.65) && !FalseAlarmDetector::isLikelyFalseAlarm(medium, recent, fever));
+        recent[0].value = 40.0;
+        assert(!FalseAlarmDetector::isLikelyFalseAlarm(medium, recent, fever));
+        MonitorClock::useRealTime();
+        
+        std::cout << "✓ Adaptive baseline test passed" << std::endl;
     }
     
-    void createDevicesForPatient(int patientId) {
-        // Create one device for each vital sign
-        devices.push_back(std::make_unique<MedicalDevice>(devices.size(), VitalSign::HEART_RATE, patientId));
-        devices.push_back(std::make_unique<MedicalDevice>(devices.size(), VitalSign::BLOOD_PRESSURE, patientId));
-        devices.push_back(std::make_unique<MedicalDevice>(devices.size(), VitalSign::OXYGEN_SATURATION, patientId));
-        devices.push_back(std::make_unique<MedicalDevice>(devices.size(), VitalSign::TEMPERATURE, patientId));
+    static void testQuantileSketches() {
+        // Rank error stays within a few percent in O(k) memory
+        KllSketch odd, even;
+        for (int i = 0; i < 200000; ++i) {
+            (i % 2 ? odd : even).update(static_cast<double>((i * 7919) % 200000));
+        }
+        KllSketch all = even;
+        all.merge(odd);
+        assert(all.getCount() == 200000);
+        for (double q : {0.05, 0.5, 0.95}) {
+            assert(std::abs(all.quantile(q) - q * 200000.0) < 0.02 * 200000.0);
+            assert(std::abs(odd.quantile(q) - q * 200000.0) < 0.02 * 200000.0);
+        }
+        assert(std::abs(all.rank(50000.0) - 0.25) < 0.02);
+        
+        std::stringstream snapshot;
+        all.serialize(snapshot);
+        KllSketch restored;
+        assert(KllSketch::deserialize(snapshot, restored));
+        assert(restored.getCount() == all.getCount() && restored.quantile(0.5) == all.quantile(0.5));
+        std::stringstream garbage("not a sketch");
+        assert(!KllSketch::deserialize(garbage, restored));
+        
+        // Windows forget epochs older than two lengths
+        MonitorClock::time_point t0(std::chrono::hours(80));
+        WindowedSketch window(std::chrono::minutes(30));
+        for (int i = 0; i < 1000; ++i) window.update(60.0, t0 + std::chrono::seconds(i));
+        for (int i = 0; i < 1000; ++i) window.update(120.0, t0 + std::chrono::minutes(35) + std::chrono::seconds(i));
+        assert(window.snapshot(t0 + std::chrono::minutes(50)).quantile(0.25) == 60.0);
+        assert(window.snapshot(t0 + std::chrono::minutes(75)).quantile(0.25) == 120.0);
+        assert(window.snapshot(t0 + std::chrono::hours(3)).empty());
+        
+        // Ward and per-patient views from live ingestion, mergeable across units
+        MonitorClock::useSimulatedTime(t0);
+        HospitalScheduler unitA, unitB;
+        for (HospitalScheduler* unit : {&unitA, &unitB}) {
+            unit->setVerbose(false);
+            unit->admitCensus(Census::generate(50));
+        }
+        for (int second = 0; second < 200; ++second) {
+            for (int pid = 1; pid <= 50; ++pid) {
+                unitA.processVitalReading(VitalReading(VitalSign::HEART_RATE, 60.0 + pid % 20, pid));
+                unitB.processVitalReading(VitalReading(VitalSign::HEART_RATE, 80.0 + pid % 20, pid));
+            }
+            MonitorClock::advance(std::chrono::seconds(1));
+        }
+        assert(std::abs(unitA.getWardQuantile(VitalSign::HEART_RATE, 0.5) - 68.0) <= 1.0);
+        assert(std::isnan(unitA.getWardQuantile(VitalSign::TEMPERATURE, 0.5)));
+        assert(unitA.getPatientPercentile(3, VitalSign::HEART_RATE, 62.0) == 0.0);
+        assert(unitA.getPatientPercentile(3, VitalSign::HEART_RATE, 63.0) == 1.0);
+        
+        std::stringstream wardSnapshot;
+        unitA.writeDistributionSnapshot(wardSnapshot);
+        std::vector<KllSketch> shards;
+        assert(HospitalScheduler::readDistributionSnapshot(wardSnapshot, shards) && shards.size() == VITAL_SIGN_COUNT);
+        KllSketch hospital = shards[static_cast<size_t>(VitalSign::HEART_RATE)];
+        hospital.merge(unitB.getWardDistribution(VitalSign::HEART_RATE));
+        assert(hospital.getCount() == 20000 && std::abs(hospital.quantile(0.5) - 79.5) <= 1.0);
+        
+        // Printing the statistics leaves std::cout's formatting alone
+        std::stringstream printed;
+        std::streambuf* console = std::cout.rdbuf(printed.rdbuf());
+        std::streamsize precision = std::cout.precision();
+        std::ios::fmtflags flags = std::cout.flags();
+        unitA.printStatistics();
+        std::cout.rdbuf(console);
+        assert(printed.str().find("Ward Heart Rate p5/p50/p95: ") != std::string::npos);
+        assert(std::cout.precision() == precision && std::cout.flags() == flags);
+        MonitorClock::useRealTime();
+        
+        std::cout << "✓ Quantile sketch test passed" << std::endl;
     }
     
-    void simulateMonitoringCycle() {
-        // Generate readings from all devices and process them
-        for (auto& device : devices) {
-            if (device->isDeviceActive()) {
-                VitalReading reading = device->generateReading();
-                processVitalReading(reading);
+    static void testArtifactDetectors() {
+        MonitorClock::useSimulatedTime(MonitorClock::time_point(std::chrono::hours(90)));
+        auto feed = [](Patient& patient, std::initializer_list<std::pair<VitalSign, double>> values) {
+            for (const auto& value : values) {
+                patient.addVitalReading(VitalReading(value.first, value.second, patient.getId()));
+            }
+            MonitorClock::advance(std::chrono::seconds(1));
+        };
+        auto judge = [](const AlarmDetector& detector, const Patient& patient, VitalSign vital, Priority priority) {
+            const HistorySlab& history = patient.getHistory();
+            const VitalReading& reading = history.at(vital, history.size(vital) - 1);
+            Alert alert(patient.getId(), priority, "Test", vital);
+            return detector.isLikelyFalse(AlarmContext{alert, reading, patient});
+        };
+        auto settle = [&feed](Patient& patient) {
+            for (int i = 0; i < 10; ++i) {
+                feed(patient, {{VitalSign::HEART_RATE, 75.0}, {VitalSign::OXYGEN_SATURATION, 97.0},
+                               {VitalSign::RESPIRATORY_RATE, 15.0}});
             }
+        };
+        
+        // A 65 bpm step in one second is an artifact; a 2 bpm/s climb is not
+        RateOfChangeDetector rate;
+        Patient spiking(1, "Spike", 40);
+        settle(spiking);
+        feed(spiking, {{VitalSign::HEART_RATE, 140.0}});
+        assert(judge(rate, spiking, VitalSign::HEART_RATE, Priority::HIGH));
+        Patient climbing(2, "Climb", 40);
+        for (int i = 0; i < 15; ++i) feed(climbing, {{VitalSign::HEART_RATE, 80.0 + 2.0 * i}});
+        assert(!judge(rate, climbing, VitalSign::HEART_RATE, Priority::HIGH));
+        
+        // Chatter at the threshold is judged against the readings before it,
+        // so a spike earlier in the window does not change the verdict
+        RobustZScoreDetector robust;
+        Patient hovering(3, "Hover", 40);
+        for (int i = 0; i < 10; ++i) feed(hovering, {{VitalSign::HEART_RATE, i % 2 ? 98.0 : 100.0}});
+        feed(hovering, {{VitalSign::HEART_RATE, 101.5}});
+        assert(judge(robust, hovering, VitalSign::HEART_RATE, Priority::MEDIUM));
+        feed(hovering, {{VitalSign::HEART_RATE, 170.0}});
+        feed(hovering, {{VitalSign::HEART_RATE, 101.5}});
+        assert(judge(robust, hovering, VitalSign::HEART_RATE, Priority::MEDIUM));
+        assert(!judge(robust, hovering, VitalSign::HEART_RATE, Priority::HIGH));   // MEDIUM only
+        for (int i = 0; i < 10; ++i) feed(hovering, {{VitalSign::HEART_RATE, 112.0 + i % 2}});
+        assert(!judge(robust, hovering, VitalSign::HEART_RATE, Priority::MEDIUM));   // sustained
+        
+        // A desaturation with normal, fresh HR and RR is the probe; with
+        // tachycardia it is the patient
+        CrossVitalDetector cross;
+        Patient probe(4, "Probe", 40);
+        settle(probe);
+        feed(probe, {{VitalSign::OXYGEN_SATURATION, 88.0}});
+        assert(judge(cross, probe, VitalSign::OXYGEN_SATURATION, Priority::HIGH));
+        feed(probe, {{VitalSign::HEART_RATE, 125.0}, {VitalSign::OXYGEN_SATURATION, 88.0}});
+        assert(!judge(cross, probe, VitalSign::OXYGEN_SATURATION, Priority::HIGH));
+        MonitorClock::advance(std::chrono::minutes(5));
+        feed(probe, {{VitalSign::HEART_RATE, 75.0}});
+        feed(probe, {{VitalSign::OXYGEN_SATURATION, 88.0}});
+        assert(!judge(cross, probe, VitalSign::OXYGEN_SATURATION, Priority::HIGH));   // RR is stale
+        
+        // The default pipeline holds only the artifact detectors, never
+        // filters CRITICAL and counts per detector
+        FalseAlarmDetector pipeline;
+        assert(pipeline.getDetectorCount() == 2);
+        const VitalReading& spike = spiking.getHistory().at(VitalSign::HEART_RATE, 10);
+        Alert high(1, Priority::HIGH, "Test", VitalSign::HEART_RATE);
+        Alert critical(1, Priority::CRITICAL, "Test", VitalSign::HEART_RATE);
+        assert(pipeline.judge(AlarmContext{critical, spike, spiking}) == nullptr);
+        const AlarmDetector* flagged = pipeline.judge(AlarmContext{high, spike, spiking});
+        assert(flagged && std::string(flagged->name()) == "rate-of-change");
+        assert(pipeline.getFilteredCounts().front().second == 1);
+        
+        // Filtered alarms reach the scheduler's statistics
+        HospitalScheduler scheduler;
+        scheduler.setVerbose(false);
+        scheduler.addPatient(std::make_unique<Patient>(1, "Ward", 40), false);
+        scheduler.setConfirmationPolicy(ConfirmationPolicy::immediate());
+        for (int i = 0; i < 10; ++i) {
+            scheduler.processVitalReading(VitalReading(VitalSign::HEART_RATE, 75.0, 1));
+            MonitorClock::advance(std::chrono::seconds(1));
         }
+        scheduler.processVitalReading(VitalReading(VitalSign::HEART_RATE, 140.0, 1));
+        assert(scheduler.getFalseAlarmsFiltered() == 1);
+        assert(scheduler.getEarlyWarningScore(1) == 0 && scheduler.getScoreAlertsRaised() == 0);   // nor scored
+        MonitorClock::useRealTime();
         
-        // Process all generated alerts
-        alertProcessor->processAllAlerts();
+        // Synthetic ward with deteriorating beds: the default pipeline
+        // filters the artifacts and almost none of the genuine alarms
+        DetectorBenchmark::Report report = DetectorBenchmark::run(20, 2);
+        assert(report.readings > 0 && report.results.size() == 6);
+        assert(report.artifactAlarms > 0 && report.deterioratingAlarms > 100);
+        const DetectorBenchmark::Result& combined = report.results.back();
+        assert(combined.flaggedDeteriorating <= 5);
+        assert(combined.precision() > 0.95 && report.recall(combined) > 0.9);
+        assert(report.results[1].precision() > 0.8);   // rate-of-change
+        
+        std::cout << "✓ Artifact detector test passed" << std::endl;
     }
     
-    void processVitalReading(const VitalReading& reading) {
-        auto patientIt = patients.find(reading.patientId);
-        if (patientIt == patients.end()) return;
+    static void testAlarmConfirmation() {
+        // 3-of-5 for MEDIUM, 2-of-3 for HIGH; a HIGH sample also counts as MEDIUM
+        ConfirmationPolicy policy = ConfirmationPolicy::standard();
+        AlarmConfirmation state;
+        assert(state.update(Priority::MEDIUM, policy) == Priority::LOW);
+        assert(state.update(Priority::LOW, policy) == Priority::LOW);
+        assert(state.update(Priority::HIGH, policy) == Priority::LOW);
+        assert(state.update(Priority::HIGH, policy) == Priority::HIGH);
+        assert(state.update(Priority::MEDIUM, policy) == Priority::MEDIUM);
+        assert(state.update(Priority::LOW, policy) == Priority::LOW);
         
-        Patient* patient = patientIt->second.get();
-        patient->addVitalReading(reading);
+        // Samples older than n no longer count
+        AlarmConfirmation sparse;
+        for (int i = 0; i < 4; ++i) {
+            assert(sparse.update(Priority::HIGH, policy) == Priority::LOW);
+            sparse.update(Priority::LOW, policy);
+            sparse.update(Priority::LOW, policy);
+        }
         
-        // Assess risk and create alerts if necessary
-        Priority risk = patient->assessRisk(reading);
+        // CRITICAL bypasses unless disabled; unconfirmed CRITICAL falls back to a met HIGH rule
+        AlarmConfirmation critical;
+        assert(critical.update(Priority::CRITICAL, policy) == Priority::CRITICAL);
+        policy.criticalBypass = false;
+        AlarmConfirmation strict;
+        assert(strict.update(Priority::HIGH, policy) == Priority::LOW);
+        assert(strict.update(Priority::CRITICAL, policy) == Priority::HIGH);
+        assert(strict.update(Priority::CRITICAL, policy) == Priority::CRITICAL);
+        assert(sizeof(AlarmConfirmation) <= 8);
         
-        if (risk != Priority::LOW) {
-            std::string message = generateAlertMessage(reading, risk);
-            auto alert = std::make_shared<Alert>(reading.patientId, risk, message, reading.type);
-            
-            // Check for false alarm
-            auto recentReadings = patient->getRecentReadings(reading.type, 10);
-            if (!FalseAlarmDetector::isLikelyFalseAlarm(*alert, recentReadings)) {
-                alertProcessor->addAlert(alert);
-            } else {
-                // Still log false alarms for statistics
-                std::cout << "[FALSE ALARM FILTERED] Patient " << reading.patientId 
-                          << ": " << message << std::endl;
+        // Single-sample excursions stay pending; spot-check vitals alert at once
+        MonitorClock::useSimulatedTime(MonitorClock::time_point(std::chrono::hours(100)));
+        HospitalScheduler scheduler;
+        scheduler.setVerbose(false);
+        scheduler.addPatient(std::make_unique<Patient>(1, "Test", 40), false);
+        for (int i = 0; i < 30; ++i) {
+            scheduler.processVitalReading(VitalReading(VitalSign::HEART_RATE, i % 10 == 5 ? 130.0 : 75.0, 1));
+            MonitorClock::advance(std::chrono::seconds(1));
+        }
+        assert(scheduler.getOpenAlerts(1).empty() && scheduler.getAlertsPending() == 3);
+        scheduler.processVitalReading(VitalReading(VitalSign::BLOOD_PRESSURE, 170.0, 1));
+        assert(scheduler.getOpenAlerts(1).size() == 1);
+        for (int i = 0; i < 2; ++i) {
+            scheduler.processVitalReading(VitalReading(VitalSign::HEART_RATE, 130.0, 1));
+            MonitorClock::advance(std::chrono::seconds(1));
+        }
+        assert(scheduler.getOpenAlerts(1).size() == 3 && scheduler.getAlertsPending() == 4);   // HR, BP and trend
+        MonitorClock::useRealTime();
+        
+        std::cout << "✓ Alarm confirmation test passed" << std::endl;
+    }
+    
+    static void testAlertDispatcher() {
+        auto waitUntil = [](const std::function<bool()>& done) {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (!done() && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
             }
+            return done();
+        };
+        auto makeAlert = [](Priority priority, int patientId) {
+            return std::make_shared<Alert>(patientId, priority, "Test", VitalSign::HEART_RATE);
+        };
+        
+        // CRITICAL runs on the fast lane while every worker is stuck in a LOW handler
+        std::atomic<bool> release(false);
+        std::atomic<int> criticalDone(0);
+        {
+            AlertDispatcher dispatcher(2, [&](const std::shared_ptr<Alert>& alert) {
+                if (alert->priority == Priority::CRITICAL) {
+                    criticalDone++;
+                } else {
+                    while (!release.load()) std::this_thread::yield();
+                }
+            });
+            for (int i = 0; i < 4; ++i) dispatcher.submit(makeAlert(Priority::LOW, i));
+            dispatcher.submit(makeAlert(Priority::CRITICAL, 9));
+            assert(waitUntil([&]() { return criticalDone.load() == 1; }));
+            assert(dispatcher.getHandled(Priority::LOW) == 0);
+            release = true;
+            dispatcher.waitIdle();
+            assert(dispatcher.getHandled(Priority::LOW) == 4 && dispatcher.getHandled(Priority::CRITICAL) == 1);
         }
         
-        // Check for concerning trends
-        if (patient->detectTrend(reading.type)) {
-            std::string trendMessage = "Concerning trend detected in " + vitalSignToString(reading.type);
-            auto trendAlert = std::make_shared<Alert>(reading.patientId, Priority::MEDIUM, trendMessage, reading.type);
-            alertProcessor->addAlert(trendAlert);
+        // An idle worker steals what is queued behind a blocked one
+        release = false;
+        std::atomic<int> quickDone(0);
+        {
+            AlertDispatcher dispatcher(2, [&](const std::shared_ptr<Alert>& alert) {
+                if (alert->patientId == 0) {
+                    while (!release.load()) std::this_thread::yield();
+                } else {
+                    quickDone++;
+                }
+            });
+            dispatcher.submit(makeAlert(Priority::LOW, 0));    // worker 0, blocks
+            dispatcher.submit(makeAlert(Priority::LOW, 1));    // worker 1
+            dispatcher.submit(makeAlert(Priority::LOW, 2));    // queued on worker 0
+            assert(waitUntil([&]() { return quickDone.load() == 2; }));
+            assert(dispatcher.getSteals() >= 1);
+            release = true;
+        }
+        
+        // A worker dequeues the most urgent alert first
+        release = false;
+        std::atomic<bool> blocked(false);
+        std::vector<Priority> order;
+        {
+            AlertDispatcher dispatcher(1, [&](const std::shared_ptr<Alert>& alert) {
+                if (alert->patientId == 0) {
+                    blocked = true;
+                    while (!release.load()) std::this_thread::yield();
+                } else {
+                    order.push_back(alert->priority);
+                }
+            });
+            dispatcher.submit(makeAlert(Priority::LOW, 0));
+            assert(waitUntil([&]() { return blocked.load(); }));
+            dispatcher.submit(makeAlert(Priority::MEDIUM, 1));
+            dispatcher.submit(makeAlert(Priority::LOW, 1));
+            dispatcher.submit(makeAlert(Priority::HIGH, 1));
+            release = true;
+            dispatcher.waitIdle();
         }
+        assert((order == std::vector<Priority>{Priority::HIGH, Priority::MEDIUM, Priority::LOW}));
+        
+        // Urgency wins over ownership: a worker freed while the other is
+        // blocked steals queued HIGH jobs before running its own LOW ones.
+        // LOW and HIGH alternate, so one worker's queue holds both LOWs and
+        // the other's both HIGHs; freeing each blocked worker in turn
+        // covers the one that must steal.
+        for (int first = 0; first < 2; ++first) {
+            std::atomic<int> running(0);
+            std::atomic<int> freed(-1);   // blocked patient let go, 2 for both
+            order.clear();
+            {
+                AlertDispatcher dispatcher(2, [&](const std::shared_ptr<Alert>& alert) {
+                    if (alert->patientId < 2) {
+                        running++;
+                        while (freed.load() != alert->patientId && freed.load() != 2) std::this_thread::yield();
+                    } else {
+                        order.push_back(alert->priority);
+                    }
+                });
+                dispatcher.submit(makeAlert(Priority::MEDIUM, 0));
+                dispatcher.submit(makeAlert(Priority::MEDIUM, 1));
+                assert(waitUntil([&]() { return running.load() == 2; }));
+                dispatcher.submit(makeAlert(Priority::LOW, 2));
+                dispatcher.submit(makeAlert(Priority::HIGH, 2));
+                dispatcher.submit(makeAlert(Priority::LOW, 2));
+                dispatcher.submit(makeAlert(Priority::HIGH, 2));
+                freed = first;
+                assert(waitUntil([&]() { return dispatcher.getHandled(Priority::LOW) == 2; }));
+                freed = 2;
+                dispatcher.waitIdle();
+            }
+            assert((order == std::vector<Priority>{Priority::HIGH, Priority::HIGH, Priority::LOW, Priority::LOW}));
+        }
+        
+        // Dropping a patient removes jobs nobody picked up yet
+        release = false;
+        blocked = false;
+        {
+            AlertDispatcher dispatcher(1, [&](const std::shared_ptr<Alert>& alert) {
+                if (alert->patientId == 0) {
+                    blocked = true;
+                    while (!release.load()) std::this_thread::yield();
+                }
+            });
+            dispatcher.submit(makeAlert(Priority::LOW, 0));
+            assert(waitUntil([&]() { return blocked.load(); }));
+            dispatcher.submit(makeAlert(Priority::HIGH, 5));
+            dispatcher.submit(makeAlert(Priority::MEDIUM, 6));
+            dispatcher.submit(makeAlert(Priority::LOW, 5));
+            assert(dispatcher.dropPatient(5) == 2);
+            release = true;
+            dispatcher.waitIdle();
+            assert(dispatcher.getHandled(Priority::MEDIUM) == 1 && dispatcher.getHandled(Priority::HIGH) == 0);
+        }
+        
+        // The processor hands alerts to the pool; the alert log keeps dequeue order
+        AlertProcessor processor;
+        processor.setVerbose(false);
+        std::stringstream log;
+        processor.setAlertLog(&log, MonitorClock::now());
+        std::atomic<int> handled(0);
+        processor.setAlertHandler([&handled](const Alert&) { handled++; });
+        processor.setDispatchWorkers(3);
+        for (int i = 0; i < 100; ++i) {
+            processor.addAlert(makeAlert(static_cast<Priority>(1 + i % 4), i));
+        }
+        processor.processAllAlerts();
+        processor.waitForHandlers();
+        assert(handled.load() == 100 && processor.getTotalAlertsProcessed() == 100);
+        processor.setAlertLog(nullptr, MonitorClock::time_point());
+        std::string first;
+        std::getline(log, first);
+        assert(first.find(",1,0,1,Test") != std::string::npos);   // a CRITICAL alert is logged first
+        processor.setDispatchWorkers(0);
+        
+        std::cout << "✓ Alert dispatcher test passed" << std::endl;
     }
     
-    void runSimulation(int cycles) {
-        std::cout << "Starting monitoring simulation for " << cycles << " cycles..." << std::endl;
+    static void testDispatchLanes() {
+        // Histogram percentiles are within a bucket (12.5%) of the truth
+        LatencyHistogram histogram;
+        for (int us = 1; us <= 1000; ++us) histogram.record(std::chrono::microseconds(us));
+        assert(histogram.count() == 1000 && histogram.max() == std::chrono::microseconds(1000));
+        auto p50 = histogram.percentile(0.50).count();
+        assert(p50 >= 500000 && p50 <= 562500);
+        assert(histogram.percentile(1.0) == histogram.max());
         
-        for (int i = 0; i < cycles; ++i) {
-            std::cout << "\n--- Cycle " << (i + 1) << " ---" << std::endl;
-            simulateMonitoringCycle();
+        // Background work waits behind every alert lane
+        std::vector<std::string> order;
+        std::mutex orderMutex;
+        std::atomic<bool> release(false);
+        {
+            DispatchLaneOptions lanes;
+            lanes.criticalCpus = {0};
+            AlertDispatcher dispatcher(1, [&](const std::shared_ptr<Alert>& alert) {
+                while (alert->patientId == 0 && !release) std::this_thread::yield();
+                std::lock_guard<std::mutex> lock(orderMutex);
+                order.push_back(alert->message);
+            }, lanes);
+            // Pinning may be refused (CPU 0 outside the cpuset, non-Linux
+            // builds), but the outcome is reported either way
+            const std::string& placement = dispatcher.getPlacement();
+            assert(placement.find("CRITICAL lane") != std::string::npos ||
+                   placement.find("unsupported") != std::string::npos);
             
-            // Small delay to see output
-            #ifdef _WIN32
-                system("timeout /t 1 /nobreak > nul 2>&1");
-            #else
-                system("sleep 1");
-            #endif
+            dispatcher.submit(std::make_shared<Alert>(0, Priority::LOW, "blocker", VitalSign::HEART_RATE));
+            while (dispatcher.getQueueLatency(Priority::LOW).count() == 0) std::this_thread::yield();
+            dispatcher.submitBackground([&]() {
+                std::lock_guard<std::mutex> lock(orderMutex);
+                order.push_back("compaction");
+            });
+            dispatcher.submit(std::make_shared<Alert>(1, Priority::LOW, "low", VitalSign::HEART_RATE));
+            release = true;
+            dispatcher.waitIdle();
+            assert(dispatcher.getBackgroundHandled() == 1 && dispatcher.getHandled(Priority::LOW) == 2);
         }
+        assert((order == std::vector<std::string>{"blocker", "low", "compaction"}));
+        
+        // Without dispatch workers background work runs inline
+        AlertProcessor processor;
+        bool ran = false;
+        processor.runInBackground([&ran]() { ran = true; });
+        assert(ran);
+        
+        // The pinned CRITICAL lane keeps up under a pool overload (its wait
+        // percentiles depend on the host, so they are reported, not asserted)
+        DispatchLaneOptions pinned;
+        pinned.criticalCpus = {0};
+        LaneOverloadBenchmark::Report report = LaneOverloadBenchmark::run(2, std::chrono::milliseconds(300), pinned);
+        assert(report.offeredLoad > 1.5 && report.jobs[0] >= 50);
+        
+        std::cout << "✓ Dispatch lane test passed" << std::endl;
     }
     
-    void printPatientInfo() {
-        std::cout << "\n=== Current Patients ===" << std::endl;
-        for (const auto& pair : patients) {
-            const Patient* patient = pair.second.get();
-            std::cout << "ID: " << patient->getId() 
-                      << " | Name: " << patient->getName() 
-                      << " | Risk: " << priorityToString(patient->getCurrentRisk()) << std::endl;
+    static void testPatientLocking() {
+        PriorityInheritanceMutex mutex;
+#ifdef PRIORITY_INHERITANCE
+        assert(mutex.inheritsPriority());
+#endif
+        {
+            std::lock_guard<PriorityInheritanceMutex> held(mutex);
+            bool acquired = true;
+            std::thread([&]() { acquired = mutex.try_lock(); }).join();
+            assert(!acquired);
         }
+        assert(mutex.try_lock());
+        mutex.unlock();
+        
+        // Moving a patient (admission, transfer) leaves it with a free lock
+        Patient patient(1, "Test", 40);
+        auto lock = patient.lockState();
+        Patient moved(std::move(patient));
+        assert(moved.lockState().owns_lock());
+        lock.unlock();
+        
+        // Queries run against ingestion and always see a consistent history
+        PatientContentionBenchmark::Report report = PatientContentionBenchmark::run(3, std::chrono::milliseconds(200));
+        assert(report.readingsIngested > 100 && report.snapshotsRead > 0);
+        assert(report.inconsistentSnapshots == 0);
+        assert(report.max >= report.p99 && report.p99 >= report.p50);
+        
+        std::cout << "✓ Patient locking test passed" << std::endl;
     }
     
-    void printStatistics() {
-        std::cout << "\n=== System Statistics ===" << std::endl;
-        std::cout << "Total Patients: " << patients.size() << std::endl;
-        std::cout << "Total Devices: " << devices.size() << std::endl;
-        std::cout << "Alerts Processed: " << alertProcessor->getTotalAlertsProcessed() << std::endl;
-        std::cout << "False Alarms Filtered: " << alertProcessor->getFalseAlarmsFiltered() << std::endl;
-    }
-    
-private:
-    std::string generateAlertMessage(const VitalReading& reading, Priority priority) {
-        std::string vital = vitalSignToString(reading.type);
-        return vital + " reading: " + std::to_string(static_cast<int>(reading.value)) + 
-               " (Priority: " + std::to_string(static_cast<int>(priority)) + ")";
-    }
-    
-    std::string vitalSignToString(VitalSign vital) {
-        switch (vital) {
-            case VitalSign::HEART_RATE: return "Heart Rate";
-            case VitalSign::BLOOD_PRESSURE: return "Blood Pressure";
-            case VitalSign::OXYGEN_SATURATION: return "Oxygen Saturation";
-            case VitalSign::TEMPERATURE: return "Temperature";
-            case VitalSign::RESPIRATORY_RATE: return "Respiratory Rate";
-            default: return "Unknown";
+    static void testSnapshotReads() {
+        // Readers racing a writer always copy a contiguous run of the ring
+        std::unique_ptr<HistorySlab, HistorySlabRelease> slab(HistorySlabPool::instance().acquire());
+        const int WRITES = 200000;
+        std::atomic<bool> done(false);
+        std::atomic<long> torn(0);
+        std::atomic<long> snapshots(0);
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 3; ++r) {
+            readers.emplace_back([&]() {
+                while (!done.load()) {
+                    std::vector<VitalReading> recent = slab->snapshot(VitalSign::OXYGEN_SATURATION, 40);
+                    for (size_t i = 1; i < recent.size(); ++i) {
+                        if (recent[i].value != recent[i - 1].value + 1.0 ||
+                            recent[i].timestamp - recent[i - 1].timestamp != std::chrono::seconds(1)) {
+                            torn++;
+                            break;
+                        }
+                    }
+                    snapshots++;
+                }
+            });
         }
-    }
-    
-    std::string priorityToString(Priority p) {
-        switch (p) {
-            case Priority::CRITICAL: return "CRITICAL";
-            case Priority::HIGH: return "HIGH";
-            case Priority::MEDIUM: return "MEDIUM";
-            case Priority::LOW: return "LOW";
-            default: return "UNKNOWN";
+        // Keeps writing until the readers have overlapped it many times;
+        // yielding lets them in on a single core
+        int writes = 0;
+        for (; writes < WRITES || snapshots.load() < 1000; ++writes) {
+            slab->push(VitalReading(VitalSign::OXYGEN_SATURATION, writes, 7, MonitorClock::time_point(std::chrono::seconds(writes))));
+            if (writes % 256 == 0) std::this_thread::yield();
         }
-    }
-};
-
-// Test Framework
-class TestFramework {
-public:
-    static void runAllTests() {
-        std::cout << "\n=== Running Unit Tests ===" << std::endl;
+        done = true;
+        for (auto& reader : readers) reader.join();
+        assert(torn.load() == 0);
         
-        testPatientCreation();
-        testVitalReadingProcessing();
-        testAlertGeneration();
-        testPriorityScheduling();
-        testFalseAlarmDetection();
+        std::vector<VitalReading> last = slab->snapshot(VitalSign::OXYGEN_SATURATION, 3);
+        assert(last.size() == 3 && last[2].value == writes - 1 && last[0].patientId == 7);
+        assert(last[2].timestamp == MonitorClock::time_point(std::chrono::seconds(writes - 1)));
+        assert(slab->snapshot(VitalSign::HEART_RATE, 10).empty());
+        assert(slab->snapshot(VitalSign::OXYGEN_SATURATION, 1000).size() == HistorySlab::HISTORY_CAPACITY);
         
-        std::cout << "✓ All tests passed!" << std::endl;
-    }
-    
-private:
-    static void testPatientCreation() {
-        Patient patient(1, "Test Patient", 30);
-        assert(patient.getId() == 1);
-        assert(patient.getName() == "Test Patient");
-        std::cout << "✓ Patient creation test passed" << std::endl;
-    }
-    
-    static void testVitalReadingProcessing() {
-        Patient patient(1, "Test", 30);
-        VitalReading reading(VitalSign::HEART_RATE, 200.0, 1);
-        Priority risk = patient.assessRisk(reading);
-        assert(risk == Priority::CRITICAL);
-        std::cout << "✓ Vital reading processing test passed" << std::endl;
-    }
-    
-    static void testAlertGeneration() {
-        Alert alert(1, Priority::CRITICAL, "Test alert", VitalSign::HEART_RATE);
-        assert(alert.priority == Priority::CRITICAL);
-        assert(alert.patientId == 1);
-        std::cout << "✓ Alert generation test passed" << std::endl;
-    }
-    
-    static void testPriorityScheduling() {
-        // Test alert comparator
-        auto alert1 = std::make_shared<Alert>(1, Priority::HIGH, "Test", VitalSign::HEART_RATE);
-        auto alert2 = std::make_shared<Alert>(2, Priority::CRITICAL, "Test", VitalSign::HEART_RATE);
+        // Patient risk, NEWS2 score and recent readings are readable
+        // without its lock
+        Patient patient(1, "Test", 40);
+        auto lock = patient.lockState();
+        patient.addVitalReading(VitalReading(VitalSign::HEART_RATE, 190.0, 1));
+        patient.updateEarlyWarning(VitalSign::HEART_RATE, 190.0);
+        patient.recordRisk(VitalSign::HEART_RATE, Priority::CRITICAL);
+        Priority seen = Priority::LOW;
+        size_t readings = 0;
+        int score = -1;
+        std::thread([&]() {
+            seen = patient.getCurrentRisk();
+            readings = patient.getRecentReadings(VitalSign::HEART_RATE).size();
+            score = patient.getEarlyWarningScore();
+        }).join();
+        assert(seen == Priority::CRITICAL && readings == 1 && score == 3);
+        lock.unlock();
         
-        AlertComparator comp;
-        assert(comp(alert1, alert2)); // Critical should have higher priority
-        std::cout << "✓ Priority scheduling test passed" << std::endl;
+        // A patient snapshot never pairs a reading with the risk or score
+        // of the step before it
+        HospitalScheduler scheduler;
+        scheduler.setVerbose(false);
+        scheduler.addPatient(std::make_unique<Patient>(4, "Test", 40), false);
+        std::atomic<bool> ingesting(true);
+        std::atomic<long> mixed(0);
+        std::atomic<long> patientSnapshots(0);
+        std::thread reader([&]() {
+            PatientSnapshot view;
+            while (ingesting.load()) {
+                assert(scheduler.getPatientSnapshot(4, view, 1));
+                const std::vector<VitalReading>& heartRate = view.recent[static_cast<size_t>(VitalSign::HEART_RATE)];
+                if (!heartRate.empty()) {
+                    bool high = heartRate.back().value > 100.0;
+                    if (high != (view.risk == Priority::CRITICAL) || view.earlyWarningScore != (high ? 3 : 0)) mixed++;
+                }
+                patientSnapshots++;
+            }
+        });
+        for (int i = 0; i < 20000 || patientSnapshots.load() < 1000; ++i) {
+            scheduler.processVitalReading(VitalReading(VitalSign::HEART_RATE, i % 2 ? 190.0 : 80.0, 4));
+            if (i % 64 == 0) std::this_thread::yield();
+        }
+        ingesting = false;
+        reader.join();
+        assert(mixed.load() == 0);
+        PatientSnapshot view;
+        assert(!scheduler.getPatientSnapshot(99, view));
+        
+        std::cout << "✓ Snapshot read test passed" << std::endl;
     }
     
-    static void testFalseAlarmDetection() {
-        std::vector<VitalReading> readings;
-        for (int i = 0; i < 10; ++i) {
-            readings.emplace_back(VitalSign::HEART_RATE, 75.0 + i, 1);
+#ifdef ASYNC_NOTIFICATIONS
+    static void testAsyncNotifications() {
+        std::string socketPath = "/tmp/hpms-pager-" + std::to_string(::getpid()) + ".sock";
+        
+        // One loop thread keeps 2000 pages in flight until the gateway acks them all
+        {
+            PagerMock gateway(socketPath, 2000);
+            NotificationLoop loop;
+            PagerClient pager(loop);
+            assert(pager.connect(socketPath));
+            int delivered = 0;
+            auto deliver = [&](int patientId) -> NotifyTask {
+                bool ok = co_await pager.page(patientId, Priority::HIGH, patientId, "Test page");
+                delivered += ok;
+                co_return ok;
+            };
+            for (int i = 0; i < 2000; ++i) {
+                loop.spawn(deliver(i));
+            }
+            assert(loop.runUntilIdle(std::chrono::seconds(20)));
+            assert(delivered == 2000 && gateway.getPagesReceived() == 2000);
+            assert(loop.getPeakInFlight() >= 2000 && pager.getOutstanding() == 0);
         }
         
-        Alert alert(1, Priority::MEDIUM, "Test", VitalSign::HEART_RATE);
-        bool isFalse = FalseAlarmDetector::isLikelyFalseAlarm(alert, readings);
+        // Without a gateway, or with one that stops acknowledging, pages
+        // fail at their ack deadline instead of hanging
+        {
+            NotificationLoop loop;
+            PagerClient pager(loop, std::chrono::milliseconds(200));
+            assert(!pager.connect(socketPath));
+            bool result = true;
+            auto attempt = [&]() -> NotifyTask {
+                result = co_await pager.page(1, Priority::CRITICAL, 1, "Unreachable");
+                co_return result;
+            };
+            loop.spawn(attempt());
+            assert(loop.runUntilIdle(std::chrono::seconds(5)) && !result && pager.getTimedOut() == 1);
+        }
+        {
+            PagerMock silent(socketPath, std::numeric_limits<size_t>::max());
+            NotificationLoop loop;
+            PagerClient pager(loop, std::chrono::milliseconds(200));
+            assert(pager.connect(socketPath));
+            int failed = 0;
+            auto attempt = [&](int patientId) -> NotifyTask {
+                bool ok = co_await pager.page(patientId, Priority::HIGH, patientId, "Unanswered");
+                failed += !ok;
+                co_return ok;
+            };
+            for (int i = 0; i < 10; ++i) loop.spawn(attempt(i));
+            assert(loop.runUntilIdle(std::chrono::seconds(5)));
+            assert(failed == 10 && pager.getTimedOut() == 10 && pager.getOutstanding() == 0);
+        }
         
-        std::cout << "✓ False alarm detection test passed" << std::endl;
+        // A restarted gateway is reconnected with backoff: the page in
+        // flight on the dropped connection fails, the next one is delivered
+        {
+            NotificationLoop loop;
+            PagerClient pager(loop);
+            std::vector<bool> results;
+            auto attempt = [&](int patientId) -> NotifyTask {
+                bool ok = co_await pager.page(patientId, Priority::HIGH, patientId, "Restart");
+                results.push_back(ok);
+                co_return ok;
+            };
+            auto restarted = std::make_unique<PagerMock>(socketPath);
+            assert(pager.connect(socketPath));
+            loop.spawn(attempt(1));
+            assert(loop.runUntilIdle(std::chrono::seconds(5)));
+            restarted.reset();
+            restarted = std::make_unique<PagerMock>(socketPath);
+            loop.spawn(attempt(2));
+            assert(loop.runUntilIdle(std::chrono::seconds(5)));
+            loop.spawn(attempt(3));
+            assert(loop.runUntilIdle(std::chrono::seconds(5)));
+            assert((results == std::vector<bool>{true, false, true}));
+            assert(pager.getReconnects() == 1 && pager.isConnected());
+        }
+        
+        // Alert handlers hand notifications to the notifier and return at once
+        {
+            PagerMock gateway(socketPath);
+            AsyncNotifier notifier(socketPath);
+            AlertProcessor processor;
+            processor.setVerbose(false);
+            processor.setAlertHandler([&notifier](const Alert& alert) { notifier.notify(alert); });
+            processor.setDispatchWorkers(2);
+            for (int i = 0; i < 200; ++i) {
+                processor.addAlert(std::make_shared<Alert>(i, static_cast<Priority>(1 + i % 4), "Test", VitalSign::HEART_RATE));
+            }
+            processor.processAllAlerts();
+            processor.waitForHandlers();
+            assert(notifier.waitIdle(std::chrono::seconds(10)));
+            assert(notifier.getDelivered() == 200 && notifier.getFailed() == 0);
+            processor.setDispatchWorkers(0);
+        }
+        
+        // waitIdle is bounded, and unanswered pages still complete (failed)
+        // by their deadline, so the notifier can always shut down
+        {
+            PagerMock silent(socketPath, std::numeric_limits<size_t>::max());
+            AsyncNotifier notifier(socketPath, std::chrono::milliseconds(300));
+            Alert alert(1, Priority::HIGH, "Unanswered", VitalSign::HEART_RATE);
+            for (int i = 0; i < 5; ++i) notifier.notify(alert);
+            assert(!notifier.waitIdle(std::chrono::milliseconds(50)));
+            assert(notifier.waitIdle(std::chrono::seconds(5)) && notifier.getFailed() == 5);
+        }
+        
+        std::cout << "✓ Async notification test passed" << std::endl;
     }
+#endif
 };
 
 // Helper functions for user input
@@ -603,7 +7568,55 @@ int getUserInput(const std::string& prompt, int min, int max) {
     return value;
 }
 
+// Beds above this are admitted in bulk and monitored without per-alert output
+const int INTERACTIVE_BED_LIMIT = 10;
+
+// Prompts until the id belongs to an admitted patient
+int getAdmittedPatientId(HospitalScheduler& scheduler, const std::string& prompt) {
+    while (true) {
+        int patientId = getUserInput(prompt, std::numeric_limits<int>::min() + 1, std::numeric_limits<int>::max());
+        if (scheduler.hasPatient(patientId)) return patientId;
+        std::cout << "No admitted patient with ID " << patientId << std::endl;
+    }
+}
+
+// Census file or generated ward; falls back to generated beds on a bad file
+void admitPatientsInBulk(HospitalScheduler& scheduler, int numPatients) {
+    std::string source;
+    std::cout << "Admit from census [f]ile or [g]enerate " << numPatients << " beds? ";
+    std::cin >> source;
+    
+    std::vector<CensusEntry> census;
+    if (source == "f" || source == "F") {
+        std::string path, error;
+        std::cout << "Census file (id,name,age per line): ";
+        std::cin >> path;
+        if (!Census::load(path, census, error)) {
+            std::cout << "Census not loaded (" << error << "); generating beds instead." << std::endl;
+            census.clear();
+        } else if (static_cast<int>(census.size()) > numPatients) {
+            census.resize(static_cast<size_t>(numPatients));
+        }
+    }
+    if (census.empty()) {
+        census = Census::generate(numPatients);
+    }
+    
+    std::vector<int> skipped;
+    size_t admitted = scheduler.admitCensus(census, &skipped);
+    std::cout << "Admitted " << admitted << " patients." << std::endl;
+    if (!skipped.empty()) {
+        std::cout << "Skipped " << skipped.size() << " entries with invalid or already admitted ids (first: "
+                  << skipped.front() << ")." << std::endl;
+    }
+}
+
 void addPatientsInteractively(HospitalScheduler& scheduler, int numPatients) {
+    if (numPatients > INTERACTIVE_BED_LIMIT) {
+        admitPatientsInBulk(scheduler, numPatients);
+        return;
+    }
+    
     std::vector<std::string> defaultNames = {
         "John Doe", "Jane Smith", "Bob Johnson", "Alice Brown", "Charlie Wilson",
         "Diana Prince", "Peter Parker", "Mary Johnson", "David Lee", "Sarah Connor"
@@ -645,6 +7658,9 @@ void showCycleMenu() {
     std::cout << "  [Enter] - Run normal monitoring cycle" << std::endl;
     std::cout << "  [e]     - Simulate emergency scenario" << std::endl;
     std::cout << "  [s]     - Show current statistics" << std::endl;
+    std::cout << "  [a]     - Acknowledge open alerts" << std::endl;
+    std::cout << "  [t]     - Show highest-risk patients" << std::endl;
+    std::cout << "  [p]     - Browse patients by page" << std::endl;
     std::cout << "  [q]     - Quit simulation" << std::endl;
 }
 
@@ -666,7 +7682,7 @@ VitalReading createEmergencyReading(int emergencyType, int patientId) {
 void simulateEmergency(HospitalScheduler& scheduler) {
     std::cout << "\n!!! EMERGENCY SIMULATION ACTIVATED !!!" << std::endl;
     
-    int patientId = getUserInput("Enter patient ID for emergency (1-10): ", 1, 10);
+    int patientId = getAdmittedPatientId(scheduler, "Enter patient ID for emergency: ");
     
     std::cout << "\nSelect emergency type:" << std::endl;
     std::cout << "1. Cardiac arrest (Critical heart rate)" << std::endl;
@@ -685,6 +7701,27 @@ void simulateEmergency(HospitalScheduler& scheduler) {
     std::cout << "Emergency simulation complete." << std::endl;
 }
 
+void acknowledgeAlertsInteractively(HospitalScheduler& scheduler) {
+    int patientId = getAdmittedPatientId(scheduler, "Enter patient ID to review: ");
+    scheduler.printOpenAlerts(patientId);
+    
+    std::string choice;
+    std::cout << "Acknowledge [all] alerts, one alert [#id], or [n]one? ";
+    std::cin >> choice;
+    
+    if (choice == "all" || choice == "ALL") {
+        size_t count = scheduler.acknowledgePatientAlerts(patientId);
+        std::cout << "Acknowledged " << count << " alert(s)." << std::endl;
+    } else if (!choice.empty() && choice[0] == '#') {
+        try {
+            std::uint64_t alertId = std::stoull(choice.substr(1));
+            std::cout << (scheduler.acknowledgeAlert(alertId) ? "Alert acknowledged." : "No open alert with that id.") << std::endl;
+        } catch (const std::exception&) {
+            std::cout << "Invalid alert id." << std::endl;
+        }
+    }
+}
+
 void runInteractiveCycles(HospitalScheduler& scheduler, int totalCycles) {
     for (int i = 0; i < totalCycles; ++i) {
         std::cout << "\n" << std::string(50, '=') << std::endl;
@@ -707,13 +7744,30 @@ void runInteractiveCycles(HospitalScheduler& scheduler, int totalCycles) {
             scheduler.printStatistics();
             i--; // Don't count this as a cycle
             continue;
+        } else if (input == "a" || input == "A") {
+            acknowledgeAlertsInteractively(scheduler);
+            i--; // Don't count this as a cycle
+            continue;
+        } else if (input == "t" || input == "T") {
+            scheduler.printHighestRisk(10);
+            i--; // Don't count this as a cycle
+            continue;
+        } else if (input == "p" || input == "P") {
+            int page = getUserInput("Page number: ", 1, std::numeric_limits<int>::max());
+            scheduler.printPatientInfo(static_cast<size_t>(page - 1));
+            i--; // Don't count this as a cycle
+            continue;
         } else if (input == "e" || input == "E") {
             // Simulate emergency
             simulateEmergency(scheduler);
         }
         
-        // Run normal monitoring cycle
+        // Run normal monitoring cycle; large units get a summary instead of
+        // one line per alert
         scheduler.simulateMonitoringCycle();
+        if (!scheduler.isVerbose()) {
+            scheduler.printHighestRisk(5);
+        }
         
         // Wait for user to continue
         if (i < totalCycles - 1) {
@@ -736,11 +7790,14 @@ public:
         HospitalScheduler scheduler;
         
         // Get user input for simulation parameters
-        int numPatients = getUserInput("Enter number of patients to monitor (1-10): ", 1, 10);
+        int numPatients = getUserInput("Enter number of patients to monitor (1-10000): ", 1, 10000);
         int numCycles = getUserInput("Enter number of monitoring cycles (5-50): ", 5, 50);
         
         // Add patients based on user input
         addPatientsInteractively(scheduler, numPatients);
+        if (numPatients > INTERACTIVE_BED_LIMIT) {
+            scheduler.setVerbose(false);
+        }
         
         std::cout << "\nStarting hospital monitoring simulation..." << std::endl;
         std::cout << "Monitoring " << numPatients << " patients for " << numCycles << " cycles..." << std::endl;
@@ -772,13 +7829,183 @@ public:
         scheduler.runSimulation(5);
         scheduler.printStatistics();
     }
+    
+    static void runCapacitySimulation() {
+        std::cout << "\n=== Capacity Simulation Mode ===" << std::endl;
+        
+        int numBeds = getUserInput("Enter number of beds (1-10000): ", 1, 10000);
+        int hours = getUserInput("Enter simulated shift length in hours (1-72): ", 1, 72);
+        
+        std::string recordPath;
+        std::cout << "Record reading trace to file (path, or '-' to skip): ";
+        std::cin >> recordPath;
+        
+        runCapacity(numBeds, hours, recordPath == "-" ? "" : recordPath);
+    }
+    
+    static bool runCapacity(int numBeds, int hours, const std::string& recordPath, size_t dispatchWorkers = 0) {
+        // Admissions share the run's virtual timeline, which starts at a fixed
+        // epoch (timing-wheel slots and sketch epochs align to absolute
+        // time), so a seed records the same trace whenever it is run
+        MonitorClock::useSimulatedTime(MonitorClock::time_point(std::chrono::hours(1)));
+        HospitalScheduler scheduler;
+        scheduler.setVerbose(false);
+        scheduler.setDispatchWorkers(dispatchWorkers);
+        if (!recordPath.empty() && !scheduler.startRecording(recordPath)) {
+            std::cout << "Could not open trace file: " << recordPath << std::endl;
+            MonitorClock::useRealTime();
+            return false;
+        }
+        
+        scheduler.admitCensus(Census::generate(numBeds));
+        for (int i = 1; i <= numBeds; ++i) {
+            // About 3% of beds deteriorate at some point during the shift
+            if (rand() % 100 < 3) {
+                auto profile = static_cast<DeteriorationProfile>(1 + rand() % 3);
+                auto onset = std::chrono::minutes(rand() % (hours * 60));
+                scheduler.scheduleDeterioration(i, profile, onset, std::chrono::hours(2));
+            }
+        }
+        
+        std::cout << "\nSimulating " << hours << "h of virtual time for " << numBeds << " beds..." << std::endl;
+        SimulationReport report = scheduler.runEventDrivenSimulation(std::chrono::hours(hours));
+        
+        std::cout << "Readings generated: " << report.readingsGenerated << std::endl;
+        std::cout << "Alerts processed: " << report.alertsProcessed << std::endl;
+        std::ostringstream wall;
+        wall << std::fixed << std::setprecision(2)
+             << "Wall time: " << report.wallSeconds << "s ("
+             << (report.wallSeconds > 0 ? report.simulatedSeconds / report.wallSeconds : 0.0)
+             << "x real time)";
+        std::cout << wall.str() << std::endl;
+        if (!recordPath.empty()) {
+            std::cout << "Recorded " << scheduler.stopRecording() << " readings to " << recordPath << std::endl;
+        }
+        scheduler.printStatistics();
+        if (const AlertDispatcher* dispatcher = scheduler.getAlertDispatcher()) {
+            dispatcher->printLaneLatency(std::cout);
+        }
+        MonitorClock::useRealTime();
+        return true;
+    }
+    
+    static void runTraceReplay() {
+        std::cout << "\n=== Trace Replay Mode ===" << std::endl;
+        
+        std::string tracePath, alertLogPath;
+        std::cout << "Trace file: ";
+        std::cin >> tracePath;
+        int speed = getUserInput("Replay speed (0 = as fast as possible, N = N x real time): ", 0, 100000);
+        std::cout << "Write alert log to file (path, or '-' for none): ";
+        std::cin >> alertLogPath;
+        
+        replay(tracePath, speed, alertLogPath == "-" ? "" : alertLogPath);
+    }
+    
+    static bool replay(const std::string& tracePath, double speed, const std::string& alertLogPath) {
+        std::ofstream alertLog;
+        if (!alertLogPath.empty()) {
+            alertLog.open(alertLogPath, std::ios::trunc);
+            if (!alertLog) {
+                std::cout << "Could not open alert log: " << alertLogPath << std::endl;
+                return false;
+            }
+        }
+        
+        HospitalScheduler scheduler;
+        scheduler.setVerbose(false);
+        TraceReplayer::ReplayReport report;
+        if (!TraceReplayer::replay(scheduler, tracePath, speed, alertLogPath.empty() ? nullptr : &alertLog, report)) {
+            std::cout << "Not a valid trace file: " << tracePath << std::endl;
+            return false;
+        }
+        
+        std::cout << "Replayed " << report.readingsReplayed << " readings for "
+                  << report.patientsAdmitted << " patients in " << report.wallSeconds << "s" << std::endl;
+        scheduler.printStatistics();
+        return true;
+    }
+    
+    // Non-interactive entry points for CI runs on fixed traces:
+    //   --record <trace> --beds N --hours H [--seed S]
+    //   --replay <trace> [--speed N|max] [--alert-log <file>]
+    static int runCommandLine(const std::vector<std::string>& args) {
+        std::map<std::string, std::string> options;
+        for (size_t i = 0; i + 1 < args.size(); i += 2) {
+            options[args[i]] = args[i + 1];
+        }
+        
+        try {
+            if (options.count("--record")) {
+                std::uint64_t seed = options.count("--seed") ? std::stoull(options["--seed"]) : 1;
+                srand(static_cast<unsigned>(seed));
+                MedicalDevice::setSimulationSeed(seed);
+                int beds = options.count("--beds") ? std::stoi(options["--beds"]) : 10;
+                int hours = options.count("--hours") ? std::stoi(options["--hours"]) : 1;
+                size_t workers = options.count("--workers") ? std::stoul(options["--workers"]) : 0;
+                return runCapacity(beds, hours, options["--record"], workers) ? 0 : 1;
+            }
+            if (options.count("--detector-bench")) {
+                int beds = std::stoi(options["--detector-bench"]);
+                int hours = options.count("--hours") ? std::stoi(options["--hours"]) : 6;
+                std::uint64_t seed = options.count("--seed") ? std::stoull(options["--seed"]) : 1;
+                std::cout << "False-alarm detector benchmark: " << beds << " beds, " << hours << "h" << std::endl;
+                DetectorBenchmark::print(DetectorBenchmark::run(beds, hours, seed));
+                return 0;
+            }
+            if (options.count("--lane-bench")) {
+                auto duration = std::chrono::milliseconds(std::stol(options["--lane-bench"]));
+                size_t workers = options.count("--workers") ? std::stoul(options["--workers"]) : 2;
+                DispatchLaneOptions lanes;
+                if (options.count("--critical-cpus")) {
+                    std::stringstream cpus(options["--critical-cpus"]);
+                    for (std::string cpu; std::getline(cpus, cpu, ',');) lanes.criticalCpus.push_back(std::stoi(cpu));
+                }
+                lanes.realtime = options.count("--realtime") && options["--realtime"] != "0";
+                lanes.lockMemory = options.count("--mlock") && options["--mlock"] != "0";
+                std::cout << "Dispatch lane overload: " << workers << " workers, " << duration.count() << "ms" << std::endl;
+                LaneOverloadBenchmark::print(LaneOverloadBenchmark::run(workers, duration, lanes));
+                return 0;
+            }
+            if (options.count("--contention-bench")) {
+                auto duration = std::chrono::milliseconds(std::stol(options["--contention-bench"]));
+                int readers = options.count("--readers") ? std::stoi(options["--readers"]) : 4;
+                bool realtime = options.count("--realtime") && options["--realtime"] != "0";
+                std::cout << "CRITICAL ingestion vs. patient queries: " << duration.count() << "ms per run" << std::endl;
+                PatientContentionBenchmark::Report quiet = PatientContentionBenchmark::run(0, duration, realtime);
+                PatientContentionBenchmark::printHeader(quiet);
+                PatientContentionBenchmark::print(quiet, 0);
+                PatientContentionBenchmark::print(PatientContentionBenchmark::run(readers, duration, realtime), readers);
+                return 0;
+            }
+            if (options.count("--replay")) {
+                std::string speed = options.count("--speed") ? options["--speed"] : "max";
+                return replay(options["--replay"], speed == "max" ? 0.0 : std::stod(speed),
+                              options.count("--alert-log") ? options["--alert-log"] : "") ? 0 : 1;
+            }
+        } catch (const std::exception&) {
+            // Fall through to usage
+        }
+        
+        std::cerr << "Usage: --record <trace> --beds N --hours H [--seed S] [--workers N]\n"
+                  << "       --replay <trace> [--speed N|max] [--alert-log <file>]\n"
+                  << "       --detector-bench <beds> [--hours H] [--seed S]\n"
+                  << "       --lane-bench <ms> [--workers N] [--critical-cpus 0,1] [--realtime 1] [--mlock 1]\n"
+                  << "       --contention-bench <ms> [--readers R] [--realtime 1]" << std::endl;
+        return 2;
+    }
 };
 
 // Main function with interactive menu
-int main() {
+int main(int argc, char* argv[]) {
     try {
+        if (argc > 1) {
+            return HospitalSimulation::runCommandLine(std::vector<std::string>(argv + 1, argv + argc));
+        }
+        
         // Initialize random seed for realistic simulation
         srand(static_cast<unsigned>(time(nullptr)));
+        MedicalDevice::setSimulationSeed(static_cast<std::uint64_t>(time(nullptr)));
         
         std::cout << "Hospital Patient Monitoring Scheduler" << std::endl;
         std::cout << "====================================" << std::endl;
@@ -791,8 +8018,10 @@ int main() {
             std::cout << "1. Run Interactive Simulation" << std::endl;
             std::cout << "2. Run Quick Demo (5 patients, 5 cycles)" << std::endl;
             std::cout << "3. Run Unit Tests Only" << std::endl;
-            std::cout << "4. Exit" << std::endl;
-            std::cout << "\nEnter your choice (1-4): ";
+            std::cout << "4. Run Capacity Simulation (event-driven, virtual time)" << std::endl;
+            std::cout << "5. Replay Recorded Trace" << std::endl;
+            std::cout << "6. Exit" << std::endl;
+            std::cout << "\nEnter your choice (1-6): ";
             
             int choice;
             std::cin >> choice;
@@ -811,11 +8040,19 @@ int main() {
                     break;
                     
                 case 4:
+                    HospitalSimulation::runCapacitySimulation();
+                    break;
+                    
+                case 5:
+                    HospitalSimulation::runTraceReplay();
+                    break;
+                    
+                case 6:
                     std::cout << "Thank you for using Hospital Patient Monitoring Scheduler!" << std::endl;
                     return 0;
                     
                 default:
-                    std::cout << "Invalid choice! Please enter 1-4." << std::endl;
+                    std::cout << "Invalid choice! Please enter 1-6." << std::endl;
                     break;
             }
             